@@ -0,0 +1,324 @@
+/// @file       LTAPIBench.cpp
+/// @brief      Benchmark of LTAPIConnect::UpdateAcListNum() against the headless XPLM stand-in
+/// @details    Drives UpdateAcListNum() with synthetic fleets of different sizes,
+///             different bulk sizes, and different churn rates, and reports
+///             per call: time per aircraft, bytes copied, heap allocations,
+///             p50/p99 latency, and the share of time spent in `XPLMGetDatab`.
+///             Then compares position queries on LTAPIAcColumns and LTAPIGridIndex
+///             with a naive scan of the aircraft map at 10,000 aircraft.\n
+///             Call with `--quick` for a reduced matrix,
+///             with `--pool` to allocate aircraft objects from LTAPIConnect's pool,
+///             with `--lod` to fetch numeric data by distance-based level-of-detail tiers.
+/// @see        https://twinfan.github.io/LTAPI/
+/// @author     Birger Hoppe
+/// @copyright  (c) 2019-2025 Birger Hoppe
+/// @copyright  Permission is hereby granted, free of charge, to any person obtaining a
+///             copy of this software and associated documentation files (the "Software"),
+///             to deal in the Software without restriction, including without limitation
+///             the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///             and/or sell copies of the Software, and to permit persons to whom the
+///             Software is furnished to do so, subject to the following conditions:\n
+///             The above copyright notice and this permission notice shall be included in
+///             all copies or substantial portions of the Software.\n
+///             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///             IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///             FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///             AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///             LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///             OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+///             THE SOFTWARE.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include "LTAPI.h"
+#include "XPLMStub.h"
+
+//
+// MARK: Allocation counting
+//
+
+/// Number of heap allocations since program start
+static uint64_t gNumAlloc = 0;
+
+void* operator new (size_t n)
+{
+    ++gNumAlloc;
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[] (size_t n)
+{
+    ++gNumAlloc;
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete (void* p) noexcept                 { free(p); }
+void operator delete[] (void* p) noexcept               { free(p); }
+void operator delete (void* p, size_t) noexcept         { free(p); }
+void operator delete[] (void* p, size_t) noexcept       { free(p); }
+
+//
+// MARK: Benchmark
+//
+
+/// Result of one benchmark configuration
+struct BenchResult {
+    double      nsPerAc     = 0.0;      ///< [ns] average time per aircraft
+    double      bytesPerCall= 0.0;      ///< bytes copied by XPLMGetDatab per call
+    double      allocPerCall= 0.0;      ///< heap allocations per call
+    double      p50_us      = 0.0;      ///< [µs] median latency
+    double      p99_us      = 0.0;      ///< [µs] 99th percentile latency
+    double      hintHitRate = 0.0;      ///< hint cache hit rate
+    double      getDataShare= 0.0;      ///< share of time spent in XPLMGetDatab
+};
+
+/// @brief Runs one configuration
+/// @param numAc Fleet size
+/// @param numBulk Number of aircraft per bulk request
+/// @param churn Share of aircraft replaced per cycle
+/// @param numCalls Number of measured calls
+/// @param bPool Allocate aircraft objects from LTAPIConnect's pool?
+/// @param bLOD Fetch numeric data by level-of-detail tiers?
+static BenchResult RunBench (int numAc, int numBulk, float churn, int numCalls, bool bPool, bool bLOD)
+{
+    XPLMStub::SetFleet(numAc, 42);
+    LTAPIConnect lt = bPool ?
+        LTAPIConnect(LTAPIConnect::CreatePooled<LTAPIAircraft>, numBulk) :
+        LTAPIConnect(LTAPIAircraft::CreateNewObject, numBulk);
+    VecLTAPIAircraft vecRemoved;
+    lt.EnableLOD(bLOD);
+    
+    // Warm-up: create all aircraft, size all buffers
+    lt.sPeriodExpsv = std::chrono::seconds(0);
+    for (int i = 0; i < 3; i++) {
+        lt.UpdateAcListNumVec(&vecRemoved);
+        vecRemoved.clear();
+    }
+    lt.resetHintStats();
+    lt.resetStats();
+    XPLMStub::ResetCounters();
+    
+    std::vector<double> vLat;
+    vLat.reserve(size_t(numCalls));
+    double totalNs = 0.0;
+    uint64_t numAlloc = 0;
+    for (int i = 0; i < numCalls; i++)
+    {
+        // One cycle represents one second, like the Example's UPDATE_INTVL,
+        // so the expensive call happens every 3rd cycle (or when aircraft are added)
+        XPLMStub::Step(1.0f, churn);
+        lt.sPeriodExpsv = i % 3 == 0 ? std::chrono::seconds(0) : std::chrono::seconds(3600);
+        
+        const uint64_t alloc0 = gNumAlloc;
+        const auto t0 = std::chrono::steady_clock::now();
+        lt.UpdateAcListNumVec(&vecRemoved);
+        const auto t1 = std::chrono::steady_clock::now();
+        numAlloc += gNumAlloc - alloc0;
+        
+        const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t0).count());
+        totalNs += ns;
+        vLat.push_back(ns / 1000.0);
+        vecRemoved.clear();
+    }
+    
+    BenchResult r;
+    std::sort(vLat.begin(), vLat.end());
+    const XPLMStub::Counters& cnt = XPLMStub::GetCounters();
+    r.nsPerAc       = totalNs / double(numCalls) / double(numAc);
+    r.bytesPerCall  = double(cnt.bytesQuick + cnt.bytesExpsv) / double(numCalls);
+    r.allocPerCall  = double(numAlloc) / double(numCalls);
+    r.p50_us        = vLat[vLat.size() / 2];
+    r.p99_us        = vLat[std::min(vLat.size() - 1, vLat.size() * 99 / 100)];
+    r.hintHitRate   = lt.getHintHitRate();
+    const LTAPIConnect::UpdateStats& tot = lt.getStats().total;
+    r.getDataShare  = tot.nsTotal ? double(tot.nsQuick + tot.nsExpsv) / double(tot.nsTotal) : 0.0;
+    return r;
+}
+
+//
+// MARK: Query benchmark
+//
+
+/// Naive radius check like a plugin would do it on the map, same formula as LTAPIAcColumns::findWithinRadius()
+static bool NaiveInRadius (const LTAPIAircraft& ac, double lat0, double lon0, double kx, double r2)
+{
+    double dLon = ac.getLon() - lon0;
+    if (dLon > 180.0) dLon -= 360.0;
+    if (dLon < -180.0) dLon += 360.0;
+    const double dx = dLon * kx;
+    const double dy = (ac.getLat() - lat0) * 60.0;
+    return dx*dx + dy*dy <= r2;
+}
+
+/// @brief Compares radius, box, and altitude band queries on the column view with a naive map scan
+/// @param numAc Fleet size
+/// @param numQueries Number of queries per predicate
+static void RunQueryBench (int numAc, int numQueries)
+{
+    XPLMStub::SetFleet(numAc, 42);
+    LTAPIConnect lt(LTAPIAircraft::CreateNewObject, 100);
+    lt.EnableColumns();
+    lt.EnableGrid();
+    lt.UpdateAcListNum();
+    const MapLTAPIAircraftNum& mapAc = lt.getAcMapNum();
+    const LTAPIAcColumns& cols = lt.getColumns();
+    std::vector<uint32_t> vIdx;
+    vIdx.reserve(cols.size());
+    
+    // Query positions move around the fleet's center
+    const double lat0 = 50.0, lon0 = 8.5;
+    auto QLat = [&](int q) { return lat0 + double(q % 21 - 10) * 0.1; };
+    auto QLon = [&](int q) { return lon0 + double(q % 17 - 8) * 0.1; };
+    
+    // Times the given query function, returns [ns] per query and total number of matches
+    auto Time = [&](auto&& fQuery, uint64_t& numMatches) -> double {
+        numMatches = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int q = 0; q < numQueries; q++)
+            numMatches += fQuery(q);
+        const auto t1 = std::chrono::steady_clock::now();
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t0).count()) / double(numQueries);
+    };
+    
+    printf("\n%7s %-10s | %12s %12s %8s %s\n",
+           "fleet", "query", "map ns/q", "index ns/q", "speedup", "matches");
+    auto Report = [&](const char* name, double nsMap, uint64_t mMap, double nsCols, uint64_t mCols) {
+        printf("%7d %-10s | %12.0f %12.0f %7.1fx %s\n",
+               numAc, name, nsMap, nsCols, nsMap / nsCols,
+               mMap == mCols ? "equal" : "DIFFERENT");
+        fflush(stdout);
+    };
+    
+    // radius of 50nm
+    {
+        const double nm = 50.0;
+        uint64_t mMap = 0, mCols = 0;
+        const double nsMap = Time([&](int q) {
+            const double kx = 60.0 * std::cos(QLat(q) * 3.14159265358979323846 / 180.0);
+            size_t n = 0;
+            for (const MapLTAPIAircraftNum::value_type& p: mapAc)
+                if (NaiveInRadius(*p.second, QLat(q), QLon(q), kx, nm*nm))
+                    n++;
+            return n;
+        }, mMap);
+        const double nsCols = Time([&](int q) {
+            return cols.findWithinRadius(QLat(q), QLon(q), nm, vIdx);
+        }, mCols);
+        Report("radius", nsMap, mMap, nsCols, mCols);
+    }
+    
+    // box of 1° x 1.5°
+    {
+        uint64_t mMap = 0, mCols = 0;
+        const double nsMap = Time([&](int q) {
+            size_t n = 0;
+            for (const MapLTAPIAircraftNum::value_type& p: mapAc) {
+                const LTAPIAircraft& ac = *p.second;
+                if (ac.getLat() >= QLat(q) - 0.5  && ac.getLat() <= QLat(q) + 0.5 &&
+                    ac.getLon() >= QLon(q) - 0.75 && ac.getLon() <= QLon(q) + 0.75)
+                    n++;
+            }
+            return n;
+        }, mMap);
+        const double nsCols = Time([&](int q) {
+            return cols.findInBox(QLat(q) - 0.5, QLat(q) + 0.5, QLon(q) - 0.75, QLon(q) + 0.75, vIdx);
+        }, mCols);
+        Report("box", nsMap, mMap, nsCols, mCols);
+    }
+    
+    // altitude band of 4,000ft
+    {
+        auto AltMin = [](int q) { return double(q % 35) * 1000.0; };
+        uint64_t mMap = 0, mCols = 0;
+        const double nsMap = Time([&](int q) {
+            size_t n = 0;
+            for (const MapLTAPIAircraftNum::value_type& p: mapAc)
+                if (p.second->getAltFt() >= AltMin(q) && p.second->getAltFt() <= AltMin(q) + 4000.0)
+                    n++;
+            return n;
+        }, mMap);
+        const double nsCols = Time([&](int q) {
+            return cols.findInAltBand(AltMin(q), AltMin(q) + 4000.0, vIdx);
+        }, mCols);
+        Report("alt band", nsMap, mMap, nsCols, mCols);
+    }
+    
+    // nearest 10 aircraft, via grid index (match count is the sum of distances)
+    {
+        std::vector<std::pair<double,const LTAPIAircraft*>> vDist;
+        vDist.reserve(mapAc.size());
+        LTAPIGridIndex::VecHit vHits;
+        uint64_t mMap = 0, mGrid = 0;
+        const double nsMap = Time([&](int q) {
+            const double kx = 60.0 * std::cos(QLat(q) * 3.14159265358979323846 / 180.0);
+            vDist.clear();
+            for (const MapLTAPIAircraftNum::value_type& p: mapAc) {
+                const double dx = (p.second->getLon() - QLon(q)) * kx;
+                const double dy = (p.second->getLat() - QLat(q)) * 60.0;
+                vDist.emplace_back(std::sqrt(dx*dx + dy*dy), p.second.get());
+            }
+            std::partial_sort(vDist.begin(), vDist.begin() + 10, vDist.end());
+            double sum = 0.0;
+            for (int i = 0; i < 10; i++) sum += vDist[size_t(i)].first;
+            return uint64_t(sum * 1000.0);
+        }, mMap);
+        const double nsGrid = Time([&](int q) {
+            lt.getGrid().nearestN(QLat(q), QLon(q), 10, vHits);
+            double sum = 0.0;
+            for (const LTAPIGridIndex::Hit& h: vHits) sum += h.dist_nm;
+            return uint64_t(sum * 1000.0);
+        }, mGrid);
+        Report("nearest10", nsMap, mMap, nsGrid, mGrid);
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    bool bQuick = false, bPool = false, bLOD = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--quick")) bQuick = true;
+        if (!strcmp(argv[i], "--pool"))  bPool = true;
+        if (!strcmp(argv[i], "--lod"))   bLOD = true;
+    }
+    const std::vector<int> vFleet = bQuick ?
+        std::vector<int>{ 10, 1000, 10000 } :
+        std::vector<int>{ 10, 100, 1000, 5000, 10000, 50000 };
+    const std::vector<int> vBulk = bQuick ?
+        std::vector<int>{ 1, 50 } :
+        std::vector<int>{ 1, 10, 50, 100 };
+    const std::vector<float> vChurn = bQuick ?
+        std::vector<float>{ 0.0f, 0.05f } :
+        std::vector<float>{ 0.0f, 0.01f, 0.05f, 0.20f };
+    
+    printf("%7s %5s %6s | %9s %12s %10s %10s %10s %6s %6s\n",
+           "fleet", "bulk", "churn", "ns/ac", "bytes/call", "alloc/call", "p50 us", "p99 us", "hint", "getD");
+    for (int numAc: vFleet)
+        for (int numBulk: vBulk)
+            for (float churn: vChurn)
+            {
+                // enough calls for a meaningful p99 without running forever on large fleets
+                const int numCalls = std::max(30, std::min(1000, 2000000 / numAc));
+                const BenchResult r = RunBench(numAc, numBulk, churn, numCalls, bPool, bLOD);
+                printf("%7d %5d %5.0f%% | %9.1f %12.0f %10.1f %10.1f %10.1f %5.1f%% %5.1f%%\n",
+                       numAc, numBulk, churn * 100.0f,
+                       r.nsPerAc, r.bytesPerCall, r.allocPerCall,
+                       r.p50_us, r.p99_us, r.hintHitRate * 100.0,
+                       r.getDataShare * 100.0);
+                fflush(stdout);
+            }
+    
+    // Position queries at 10k aircraft
+    RunQueryBench(10000, bQuick ? 200 : 2000);
+    return 0;
+}
@@ -311,6 +311,8 @@ public:
     ~EnhAircraft() override;
     // we add some simplistic logic to derive a line number for output
     bool updateAircraft(const LTAPIBulkData& __bulk, size_t __inSize) override;
+    // called only if texts actually changed: highlight the line again
+    void textsChanged () override;
     // test out notifications of camera toggle
     void toggleCamera (bool bCameraActive, SPtrLTAPIAircraft spPrevAc) override;
     
@@ -365,6 +367,16 @@ bool EnhAircraft::updateAircraft(const LTAPIBulkData& __bulk, size_t __inSize)
     return true;
 }
 
+// Texts like call sign or destination have changed.
+// Override this instead of updateAircraft() for texts, which LTAPI calls
+// for every aircraft with every expensive fetch, changed or not.
+void EnhAircraft::textsChanged ()
+{
+    // show in yellow again until the next numeric update
+    if (dispStatus == ED_SHOWN)
+        dispStatus = ED_NONE;
+}
+
 // test out notifications of camera toggle
 void EnhAircraft::toggleCamera (bool bCameraActive, SPtrLTAPIAircraft spPrevAc)
 {
@@ -470,7 +482,7 @@ void EnhAircraft::DrawOutput(int x, int y, int r, int) const
 // 1. Have one (probably even static) object of LTAPIConnect
 //    This time we pass in our own object creation callback,
 //    so that objects are of type EnhAircraft
-LTAPIConnect ltEnhanced(EnhAircraft::CreateNewObject, 10);
+LTAPIConnect ltEnhanced(LTAPIConnect::CreatePooled<EnhAircraft>, 10);
 // And we manage removed aircrafts ourself!
 ListLTAPIAircraft listRemovedAc;
 
@@ -0,0 +1,1204 @@
+/// @file       LTAPITest.cpp
+/// @brief      Tests of LTAPIConnect against the headless XPLM stand-in
+/// @details    Each test drives LTAPIConnect with a synthetic fleet served by
+///             XPLMStub and checks one property. Exits with a non-zero code
+///             if any test fails, so it can run via `ctest`.\n
+///             Pass test names as arguments to run only those.
+/// @see        https://twinfan.github.io/LTAPI/
+/// @author     Birger Hoppe
+/// @copyright  (c) 2019-2025 Birger Hoppe
+/// @copyright  Permission is hereby granted, free of charge, to any person obtaining a
+///             copy of this software and associated documentation files (the "Software"),
+///             to deal in the Software without restriction, including without limitation
+///             the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///             and/or sell copies of the Software, and to permit persons to whom the
+///             Software is furnished to do so, subject to the following conditions:\n
+///             The above copyright notice and this permission notice shall be included in
+///             all copies or substantial portions of the Software.\n
+///             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///             IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///             FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///             AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///             LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///             OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+///             THE SOFTWARE.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <new>
+#include <vector>
+#include <unordered_set>
+#include <unordered_map>
+#include <string>
+#include <chrono>
+#include <thread>
+
+#include "LTAPI.h"
+#include "XPLMStub.h"
+
+//
+// MARK: Allocation counting
+//
+
+/// Number of heap allocations since program start
+static uint64_t gNumAlloc = 0;
+
+void* operator new (size_t n)
+{
+    ++gNumAlloc;
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[] (size_t n)
+{
+    ++gNumAlloc;
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete (void* p) noexcept                 { free(p); }
+void operator delete[] (void* p) noexcept               { free(p); }
+void operator delete (void* p, size_t) noexcept         { free(p); }
+void operator delete[] (void* p, size_t) noexcept       { free(p); }
+
+//
+// MARK: Helpers
+//
+
+/// @brief Number of differences between an aircraft map and the fleet LiveTraffic serves
+/// @details Counts aircraft missing from or surplus in the map, and aircraft at different positions
+static int DiffFleet (const MapLTAPIAircraftNum& mapAc)
+{
+    const int numAc = XPLMStub::GetNumAc();
+    int numDiff = std::abs(int(mapAc.size()) - numAc);
+    for (int k = 0; k < numAc; k++) {
+        const auto iter = mapAc.find(XPLMStub::GetKey(k));
+        double lat, lon, alt_ft;
+        XPLMStub::GetPos(k, lat, lon, alt_ft);
+        if (iter == mapAc.end() ||
+            std::fabs(iter->second->getLat()   - lat)    > 0.0 ||
+            std::fabs(iter->second->getLon()   - lon)    > 0.0 ||
+            std::fabs(iter->second->getAltFt() - alt_ft) > 0.0)
+            numDiff++;
+    }
+    return numDiff;
+}
+
+//
+// MARK: Tests
+//
+
+/// @brief Once warmed up, UpdateAcListNumVec() must not allocate, neither updating nor removing aircraft
+static bool TestNoAlloc ()
+{
+    constexpr int NUM_AC = 2000;
+    constexpr int NUM_CALLS = 50;
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 7);
+    LTAPIConnect lt;
+    VecLTAPIAircraft vecRemoved;
+    vecRemoved.reserve(NUM_AC);
+
+    // Warm-up: create all aircraft, size all buffers, including the expensive fetch
+    lt.sPeriodExpsv = std::chrono::seconds(0);
+    for (int i = 0; i < 3; i++)
+        lt.UpdateAcListNumVec(&vecRemoved);
+    if (lt.getAcMapNum().size() != size_t(NUM_AC)) {
+        printf("  expected %d aircraft after warm-up, got %zu\n", NUM_AC, lt.getAcMapNum().size());
+        return false;
+    }
+
+    // Steady state: aircraft move, every 3rd call also fetches the texts
+    uint64_t numAlloc = 0;
+    for (int i = 0; i < NUM_CALLS; i++) {
+        XPLMStub::Step(1.0f);
+        lt.sPeriodExpsv = i % 3 == 0 ? std::chrono::seconds(0) : std::chrono::seconds(3600);
+        const uint64_t alloc0 = gNumAlloc;
+        lt.UpdateAcListNumVec(&vecRemoved);
+        numAlloc += gNumAlloc - alloc0;
+    }
+
+    // Removal of all aircraft into the reserved vector
+    XPLMStub::SetLTAvail(false);
+    const uint64_t alloc0 = gNumAlloc;
+    lt.UpdateAcListNumVec(&vecRemoved);
+    numAlloc += gNumAlloc - alloc0;
+    XPLMStub::SetLTAvail(true);
+
+    if (vecRemoved.size() != size_t(NUM_AC)) {
+        printf("  expected %d removed aircraft, got %zu\n", NUM_AC, vecRemoved.size());
+        return false;
+    }
+    if (numAlloc > 0) {
+        printf("  %llu heap allocations in %d warmed-up calls\n",
+               (unsigned long long)numAlloc, NUM_CALLS + 1);
+        return false;
+    }
+    return true;
+}
+
+/// @brief Hint cache hits and misses must result in the same map as a cold lookup, also under churn
+static bool TestHintCache ()
+{
+    constexpr int NUM_AC = 2000;
+    constexpr int NUM_CALLS = 30;
+    const struct { float churn; double minHitRate; } CASES[] = {
+        { 0.0f,  0.999 },
+        { 0.01f, 0.97 },
+        { 0.05f, 0.90 },
+    };
+    XPLMStub::SetLTAvail(true);
+    for (const auto& c: CASES) {
+        XPLMStub::SetFleet(NUM_AC, 29);
+        LTAPIConnect lt;
+        lt.UpdateAcListNum();
+        lt.resetHintStats();
+        int numDiff = 0, numDiffCold = 0;
+        for (int i = 0; i < NUM_CALLS; i++) {
+            XPLMStub::Step(1.0f, c.churn);
+            lt.UpdateAcListNum();
+            numDiff += DiffFleet(lt.getAcMapNum());
+            // a fresh connection finds all aircraft without hints
+            LTAPIConnect ltCold;
+            ltCold.UpdateAcListNum();
+            numDiffCold += DiffFleet(ltCold.getAcMapNum());
+        }
+        printf("  churn %4.1f%%: hint hit rate %.3f\n", c.churn * 100.0f, lt.getHintHitRate());
+        if (numDiff || numDiffCold || lt.getHintHitRate() < c.minHitRate) {
+            printf("  churn %.1f%%: %d differences with hints, %d without, hit rate %.3f < %.3f\n",
+                   c.churn * 100.0f, numDiff, numDiffCold, lt.getHintHitRate(), c.minHitRate);
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Texts of all aircraft are refreshed within `sPeriodExpsv`, texts of new aircraft in the call they appear in
+static bool TestExpsvRefresh ()
+{
+    constexpr int NUM_AC = 1000;
+    constexpr int NUM_CHURN_CALLS = 20;
+    XPLMStub::SetLTAvail(true);
+    for (const bool bSlice: { false, true }) {
+        const char* szMode = bSlice ? "sliced" : "full";
+        XPLMStub::SetFleet(NUM_AC, 31);
+        LTAPIConnect lt;
+        lt.bSliceExpsv = bSlice;
+        lt.sPeriodExpsv = std::chrono::seconds(1);
+        lt.UpdateAcListNum();
+        
+        // New aircraft must have their texts right away
+        std::unordered_set<uint64_t> setKnown;
+        for (int i = 0; i < NUM_CHURN_CALLS; i++) {
+            setKnown.clear();
+            for (const auto& p: lt.getAcMapNum())
+                setKnown.insert(p.first);
+            XPLMStub::Step(0.05f, 0.01f);
+            lt.UpdateAcListNum();
+            int numNew = 0;
+            for (int k = 0; k < XPLMStub::GetNumAc(); k++) {
+                const uint64_t key = XPLMStub::GetKey(k);
+                if (setKnown.count(key))
+                    continue;
+                numNew++;
+                const auto iter = lt.getAcMapNum().find(key);
+                if (iter == lt.getAcMapNum().end() ||
+                    iter->second->getCallSignView() != XPLMStub::GetCallSign(k)) {
+                    printf("  %s: call %d: new aircraft %llx without texts\n",
+                           szMode, i, (unsigned long long)key);
+                    return false;
+                }
+            }
+            if (!numNew) {
+                printf("  %s: call %d: no new aircraft\n", szMode, i);
+                return false;
+            }
+        }
+        
+        // All aircraft get new call signs, which must all have arrived once sPeriodExpsv has passed
+        char buf[16];
+        for (int k = 0; k < XPLMStub::GetNumAc(); k++) {
+            snprintf(buf, sizeof(buf), "T%05d", k);
+            XPLMStub::SetCallSign(k, buf);
+        }
+        const auto t0 = std::chrono::steady_clock::now();
+        int numCalls = 0;
+        for (;;) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            const auto tCall = std::chrono::steady_clock::now();
+            lt.UpdateAcListNum();
+            numCalls++;
+            if (tCall - t0 > lt.sPeriodExpsv)
+                break;
+        }
+        int numStale = 0;
+        for (int k = 0; k < XPLMStub::GetNumAc(); k++) {
+            const auto iter = lt.getAcMapNum().find(XPLMStub::GetKey(k));
+            if (iter == lt.getAcMapNum().end() ||
+                iter->second->getCallSignView() != XPLMStub::GetCallSign(k))
+                numStale++;
+        }
+        if (numStale) {
+            printf("  %s: %d aircraft with stale texts after %d calls\n", szMode, numStale, numCalls);
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Events report each added and removed aircraft exactly once, and nothing if nothing changed
+static bool TestEvents ()
+{
+    constexpr int NUM_AC = 1000;
+    constexpr int NUM_CALLS = 20;
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 37);
+    LTAPIConnect lt;
+    lt.sPeriodExpsv = std::chrono::seconds(0);      // texts every call, so that text changes are seen right away
+    lt.EnableEvents();
+    
+    // Collects the keys per event type, fails on a key reported twice
+    std::unordered_set<uint64_t> setEv[3];
+    auto Collect = [&](const char* szWhen) -> bool {
+        for (auto& set: setEv) set.clear();
+        std::unordered_set<uint64_t> setAll;
+        for (const LTAPIAcEvent& e: lt.getEvents()) {
+            if (!setAll.insert(e.keyNum).second) {
+                printf("  %s: aircraft %llx reported twice\n", szWhen, (unsigned long long)e.keyNum);
+                return false;
+            }
+            setEv[e.ev].insert(e.keyNum);
+        }
+        return true;
+    };
+    
+    // Fleet keys and positions
+    struct PosTy { double lat, lon, alt_ft; };
+    auto FleetPos = []() {
+        std::unordered_map<uint64_t, PosTy> map;
+        for (int k = 0; k < XPLMStub::GetNumAc(); k++) {
+            PosTy pos;
+            XPLMStub::GetPos(k, pos.lat, pos.lon, pos.alt_ft);
+            map.emplace(XPLMStub::GetKey(k), pos);
+        }
+        return map;
+    };
+    
+    lt.UpdateAcListNum();
+    if (!Collect("first call")) return false;
+    if (setEv[LTAPIAcEvent::EV_ADDED].size() != size_t(NUM_AC) || lt.getEvents().size() != size_t(NUM_AC)) {
+        printf("  first call: %zu events, %zu added, expected %d added\n",
+               lt.getEvents().size(), setEv[LTAPIAcEvent::EV_ADDED].size(), NUM_AC);
+        return false;
+    }
+    
+    for (int i = 0; i < NUM_CALLS; i++) {
+        // Nothing changed: no events
+        lt.UpdateAcListNum();
+        if (!lt.getEvents().empty()) {
+            printf("  call %d: %zu events without changes\n", i, lt.getEvents().size());
+            return false;
+        }
+        
+        // Move and churn the fleet
+        const auto mapBefore = FleetPos();
+        XPLMStub::Step(1.0f, 0.02f);
+        const auto mapAfter = FleetPos();
+        lt.UpdateAcListNum();
+        if (!Collect("churn")) return false;
+        size_t numAdded = 0, numRemoved = 0;
+        for (const auto& p: mapAfter) {
+            const auto iter = mapBefore.find(p.first);
+            if (iter == mapBefore.end()) {
+                numAdded++;
+                if (!setEv[LTAPIAcEvent::EV_ADDED].count(p.first)) {
+                    printf("  call %d: aircraft %llx added without event\n", i, (unsigned long long)p.first);
+                    return false;
+                }
+            }
+            else if ((std::fabs(iter->second.lat    - p.second.lat)    > 0.0 ||
+                      std::fabs(iter->second.lon    - p.second.lon)    > 0.0 ||
+                      std::fabs(iter->second.alt_ft - p.second.alt_ft) > 0.0) &&
+                     !setEv[LTAPIAcEvent::EV_UPDATED].count(p.first)) {
+                printf("  call %d: aircraft %llx moved without event\n", i, (unsigned long long)p.first);
+                return false;
+            }
+        }
+        for (const auto& p: mapBefore) {
+            if (!mapAfter.count(p.first)) {
+                numRemoved++;
+                if (!setEv[LTAPIAcEvent::EV_REMOVED].count(p.first)) {
+                    printf("  call %d: aircraft %llx removed without event\n", i, (unsigned long long)p.first);
+                    return false;
+                }
+            }
+        }
+        if (!numAdded || !numRemoved ||
+            setEv[LTAPIAcEvent::EV_ADDED].size() != numAdded ||
+            setEv[LTAPIAcEvent::EV_REMOVED].size() != numRemoved) {
+            printf("  call %d: %zu added / %zu removed events for %zu added / %zu removed aircraft\n",
+                   i, setEv[LTAPIAcEvent::EV_ADDED].size(), setEv[LTAPIAcEvent::EV_REMOVED].size(),
+                   numAdded, numRemoved);
+            return false;
+        }
+        for (uint64_t key: setEv[LTAPIAcEvent::EV_UPDATED]) {
+            if (!mapBefore.count(key) || !mapAfter.count(key)) {
+                printf("  call %d: update event for aircraft %llx, which was added or removed\n",
+                       i, (unsigned long long)key);
+                return false;
+            }
+        }
+        
+        // A text change alone reports exactly that aircraft as updated
+        const int k = i % XPLMStub::GetNumAc();
+        char buf[16];
+        snprintf(buf, sizeof(buf), "EV%05d", i);
+        XPLMStub::SetCallSign(k, buf);
+        lt.UpdateAcListNum();
+        if (lt.getEvents().size() != 1 ||
+            lt.getEvents().front().ev != LTAPIAcEvent::EV_UPDATED ||
+            lt.getEvents().front().keyNum != XPLMStub::GetKey(k)) {
+            printf("  call %d: %zu events for a changed call sign, expected 1 update\n",
+                   i, lt.getEvents().size());
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Squared distance in nm, same equirectangular approximation the spatial queries document
+static double BruteDist2 (const LTAPIAircraft& ac, double lat0, double lon0)
+{
+    double dLon = ac.getLon() - lon0;
+    if (dLon > 180.0) dLon -= 360.0;
+    if (dLon < -180.0) dLon += 360.0;
+    const double dx = dLon * 60.0 * std::cos(lat0 * 3.14159265358979323846 / 180.0);
+    const double dy = (ac.getLat() - lat0) * 60.0;
+    return dx*dx + dy*dy;
+}
+
+/// @brief Column rows must represent exactly the aircraft in the map, with the same values
+static bool ColumnsMatchMap (const LTAPIConnect& lt, const char* szWhen)
+{
+    const LTAPIAcColumns& cols = lt.getColumns();
+    const MapLTAPIAircraftNum& mapAc = lt.getAcMapNum();
+    if (cols.size() != mapAc.size()) {
+        printf("  %s: %zu rows for %zu aircraft\n", szWhen, cols.size(), mapAc.size());
+        return false;
+    }
+    std::unordered_set<uint64_t> setKeys;
+    for (size_t i = 0; i < cols.size(); i++) {
+        const auto iter = mapAc.find(cols.key[i]);
+        if (!setKeys.insert(cols.key[i]).second ||
+            iter == mapAc.end() || iter->second.get() != cols.ac[i] ||
+            std::fabs(cols.lat[i]    - iter->second->getLat())   > 0.0 ||
+            std::fabs(cols.lon[i]    - iter->second->getLon())   > 0.0 ||
+            std::fabs(cols.alt_ft[i] - iter->second->getAltFt()) > 0.0) {
+            printf("  %s: row %zu (aircraft %llx) differs from the map\n",
+                   szWhen, i, (unsigned long long)cols.key[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Column rows must stay consistent with the map under churn, also with a time budget
+static bool TestColumns ()
+{
+    constexpr int NUM_AC = 3000;
+    constexpr int NUM_CALLS = 50;
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 43);
+    LTAPIConnect lt, ltBudget;
+    lt.EnableColumns();
+    ltBudget.EnableColumns();
+    ltBudget.usUpdateBudget = std::chrono::microseconds(50);
+    int numIncomplete = 0;
+    for (int i = 0; i < NUM_CALLS; i++) {
+        XPLMStub::Step(1.0f, 0.03f);
+        lt.UpdateAcListNum();
+        ltBudget.UpdateAcListNum();
+        numIncomplete += !ltBudget.isSweepComplete();
+        if (!ColumnsMatchMap(lt, "churn") || !ColumnsMatchMap(ltBudget, "budget"))
+            return false;
+    }
+    if (!numIncomplete) {
+        printf("  budget: all sweeps completed within one call\n");
+        return false;
+    }
+    return true;
+}
+
+/// @brief Column queries must find the same aircraft as a brute-force scalar scan of the map
+/// @details Built once per instruction set, see `LTAPI_TEST_SIMD` in CMakeLists.txt
+static bool TestSpatial ()
+{
+    constexpr int NUM_AC = 3000;
+    constexpr int NUM_CALLS = 10;
+    const double RADII_NM[] = { 5.0, 30.0, 120.0 };
+    
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 41);
+    LTAPIConnect lt;
+    lt.EnableColumns();
+    std::vector<uint32_t> vIdx;
+    std::vector<uint64_t> vExpected, vFound;
+    size_t numExpected = 0;
+    for (int i = 0; i < NUM_CALLS; i++) {
+        XPLMStub::Step(1.0f, 0.03f);
+        lt.UpdateAcListNum();
+        const LTAPIAcColumns& cols = lt.getColumns();
+        const MapLTAPIAircraftNum& mapAc = lt.getAcMapNum();
+        
+        // query around some aircraft and around the fleet's center
+        for (const int k: { -1, 0, NUM_AC / 2, NUM_AC - 1 }) {
+            double lat0 = 50.0, lon0 = 8.5, alt_ft;     // stub's default local origin
+            if (k >= 0)
+                XPLMStub::GetPos(k, lat0, lon0, alt_ft);
+            
+            for (const double nm: RADII_NM) {
+                vExpected.clear();
+                for (const auto& p: mapAc)
+                    if (BruteDist2(*p.second, lat0, lon0) <= nm * nm)
+                        vExpected.push_back(p.first);
+                std::sort(vExpected.begin(), vExpected.end());
+                numExpected += vExpected.size();
+                
+                // same aircraft, row indexes ascending
+                cols.findWithinRadius(lat0, lon0, nm, vIdx);
+                vFound.clear();
+                for (size_t j = 0; j < vIdx.size(); j++) {
+                    if (j > 0 && vIdx[j-1] >= vIdx[j]) {
+                        printf("  call %d: findWithinRadius rows not ascending\n", i);
+                        return false;
+                    }
+                    vFound.push_back(cols.key[vIdx[j]]);
+                }
+                std::sort(vFound.begin(), vFound.end());
+                if (vFound != vExpected) {
+                    printf("  call %d: findWithinRadius(%.1fnm) found %zu, brute force %zu\n",
+                           i, nm, vFound.size(), vExpected.size());
+                    return false;
+                }
+            }
+        }
+    }
+    if (!numExpected) {
+        printf("  no aircraft found by any query\n");
+        return false;
+    }
+    return true;
+}
+
+/// @brief Grid queries must find the same aircraft as a brute-force scan of the map, also under churn
+static bool TestGrid ()
+{
+    constexpr int NUM_AC = 3000;
+    constexpr int NUM_CALLS = 10;
+    constexpr size_t NEAREST_N = 10;
+    const double RADII_NM[] = { 5.0, 30.0, 120.0 };
+    
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 47);
+    LTAPIConnect lt;
+    lt.EnableGrid(true, 0.5);
+    LTAPIGridIndex::VecHit vHits;
+    std::vector<uint64_t> vExpected, vFound;
+    std::vector<double> vDist;
+    for (int i = 0; i < NUM_CALLS; i++) {
+        XPLMStub::Step(1.0f, 0.03f);
+        lt.UpdateAcListNum();
+        const MapLTAPIAircraftNum& mapAc = lt.getAcMapNum();
+        if (lt.getGrid().size() != mapAc.size()) {
+            printf("  call %d: %zu aircraft in the grid, %zu in the map\n",
+                   i, lt.getGrid().size(), mapAc.size());
+            return false;
+        }
+        
+        // query around some aircraft and around the fleet's center
+        for (const int k: { -1, 0, NUM_AC / 2, NUM_AC - 1 }) {
+            double lat0 = 50.0, lon0 = 8.5, alt_ft;     // stub's default local origin
+            if (k >= 0)
+                XPLMStub::GetPos(k, lat0, lon0, alt_ft);
+            
+            // within radius: same aircraft
+            for (const double nm: RADII_NM) {
+                vExpected.clear();
+                for (const auto& p: mapAc)
+                    if (BruteDist2(*p.second, lat0, lon0) <= nm * nm)
+                        vExpected.push_back(p.first);
+                std::sort(vExpected.begin(), vExpected.end());
+                lt.getGrid().withinRadius(lat0, lon0, nm, vHits);
+                vFound.clear();
+                for (const LTAPIGridIndex::Hit& h: vHits)
+                    vFound.push_back(h.pAc->getKeyNum());
+                std::sort(vFound.begin(), vFound.end());
+                if (vFound != vExpected) {
+                    printf("  call %d: withinRadius(%.1fnm) found %zu, brute force %zu\n",
+                           i, nm, vFound.size(), vExpected.size());
+                    return false;
+                }
+            }
+            
+            // nearest: same distances in the same order
+            vDist.clear();
+            for (const auto& p: mapAc)
+                vDist.push_back(std::sqrt(BruteDist2(*p.second, lat0, lon0)));
+            std::sort(vDist.begin(), vDist.end());
+            lt.getGrid().nearestN(lat0, lon0, NEAREST_N, vHits);
+            bool bOK = vHits.size() == std::min(NEAREST_N, vDist.size());
+            for (size_t j = 0; bOK && j < vHits.size(); j++)
+                bOK = std::fabs(vHits[j].dist_nm - vDist[j]) <= 1e-9;
+            if (!bOK) {
+                printf("  call %d: nearestN(%zu) differs from brute force\n", i, NEAREST_N);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// @brief Text lookups must find exactly the aircraft with that text after churn and text changes
+static bool TestTextIndex ()
+{
+    constexpr int NUM_AC = 1000;
+    constexpr int NUM_CALLS = 10;
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 53);
+    LTAPIConnect lt;
+    lt.sPeriodExpsv = std::chrono::seconds(0);      // texts every call
+    lt.EnableTextIndex();
+    lt.UpdateAcListNum();
+    
+    typedef std::string (LTAPIAircraft::*GetTextTy)() const;
+    typedef SPtrLTAPIAircraft (LTAPIConnect::*FindTy)(const std::string&) const;
+    typedef size_t (LTAPIConnect::*FindAllTy)(const std::string&, VecLTAPIAircraft&) const;
+    const struct { const char* szField; GetTextTy get; FindTy find; FindAllTy findAll; } FIELDS[] = {
+        { "call sign",      &LTAPIAircraft::getCallSign,        &LTAPIConnect::findByCallSign,      &LTAPIConnect::findAllByCallSign },
+        { "registration",   &LTAPIAircraft::getRegistration,    &LTAPIConnect::findByRegistration,  &LTAPIConnect::findAllByRegistration },
+        { "flight number",  &LTAPIAircraft::getFlightNumber,    &LTAPIConnect::findByFlightNumber,  &LTAPIConnect::findAllByFlightNumber },
+    };
+    
+    std::unordered_map<std::string, std::vector<uint64_t>> mapExpected;
+    VecLTAPIAircraft vFound, vRemoved;
+    char buf[16];
+    for (int i = 0; i < NUM_CALLS; i++) {
+        XPLMStub::Step(1.0f, 0.03f);
+        // some call signs change, some of them to one shared by several aircraft
+        for (int k = i; k < XPLMStub::GetNumAc(); k += 97) {
+            snprintf(buf, sizeof(buf), "D%02d%04d", i, k % 3 ? k : 0);
+            XPLMStub::SetCallSign(k, buf);
+        }
+        vRemoved.clear();
+        lt.UpdateAcListNumVec(&vRemoved);
+        
+        for (const auto& f: FIELDS) {
+            // brute force: keys by text, sorted
+            mapExpected.clear();
+            for (const auto& p: lt.getAcMapNum())
+                mapExpected[((*p.second).*f.get)()].push_back(p.first);
+            
+            size_t numDup = 0;
+            for (auto& p: mapExpected) {
+                std::vector<uint64_t>& vKeys = p.second;
+                std::sort(vKeys.begin(), vKeys.end());
+                numDup += vKeys.size() > 1;
+                const SPtrLTAPIAircraft spAc = (lt.*f.find)(p.first);
+                (lt.*f.findAll)(p.first, vFound);
+                bool bOK = p.first.empty() ? !spAc && vFound.empty() :
+                           spAc && spAc->getKeyNum() == vKeys.front() && vFound.size() == vKeys.size();
+                for (size_t j = 0; bOK && j < vFound.size(); j++)
+                    bOK = vFound[j] && vFound[j]->getKeyNum() == vKeys[j];
+                if (!bOK) {
+                    printf("  call %d: %s '%s': found %zu, expected %zu\n",
+                           i, f.szField, p.first.c_str(), vFound.size(), vKeys.size());
+                    return false;
+                }
+            }
+            if (f.find == &LTAPIConnect::findByCallSign && !numDup) {
+                printf("  call %d: no duplicate call signs\n", i);
+                return false;
+            }
+        }
+        
+        // removed aircraft and texts nobody has must not be found
+        for (const SPtrLTAPIAircraft& spRemoved: vRemoved) {
+            lt.findAllByCallSign(spRemoved->getCallSign(), vFound);
+            for (const SPtrLTAPIAircraft& spAc: vFound)
+                if (!spAc || spAc == spRemoved) {
+                    printf("  call %d: found removed aircraft by call sign '%s'\n",
+                           i, spRemoved->getCallSign().c_str());
+                    return false;
+                }
+        }
+        if (vRemoved.empty() || lt.findByCallSign("XXXXXXX") || lt.findAllByCallSign("", vFound)) {
+            printf("  call %d: %zu removed aircraft, or found non-existing call sign\n", i, vRemoved.size());
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Replaying a recording into a fresh connection must reproduce the recorded maps cycle by cycle
+static bool TestReplay ()
+{
+    constexpr int NUM_AC = 1000;
+    constexpr int NUM_CYCLES = 20;
+    const char* PATH = "LTAPITest_replay.cap";
+    
+    // What is compared per aircraft
+    struct AcState {
+        double      lat, lon, alt_ft;
+        float       heading;
+        std::string callSign, reg;
+        bool operator != (const AcState& o) const
+        {
+            return std::fabs(lat - o.lat) > 0.0 || std::fabs(lon - o.lon) > 0.0 ||
+                   std::fabs(alt_ft - o.alt_ft) > 0.0 || std::fabs(heading - o.heading) > 0.0f ||
+                   callSign != o.callSign || reg != o.reg;
+        }
+    };
+    typedef std::unordered_map<uint64_t, AcState> MapStateTy;
+    auto State = [](const LTAPIConnect& lt) {
+        MapStateTy map;
+        for (const auto& p: lt.getAcMapNum())
+            map.emplace(p.first, AcState{ p.second->getLat(), p.second->getLon(), p.second->getAltFt(),
+                                          p.second->getHeading(),
+                                          p.second->getCallSign(), p.second->getRegistration() });
+        return map;
+    };
+    
+    // Record
+    std::vector<MapStateTy> vRecorded;
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 59);
+    {
+        LTAPIConnect lt;
+        lt.sPeriodExpsv = std::chrono::seconds(0);  // texts every cycle
+        if (!lt.StartRecording(PATH)) {
+            printf("  could not record to %s\n", PATH);
+            return false;
+        }
+        char buf[16];
+        for (int i = 0; i < NUM_CYCLES; i++) {
+            XPLMStub::Step(1.0f, 0.03f);
+            snprintf(buf, sizeof(buf), "R%06d", i);
+            XPLMStub::SetCallSign(i, buf);
+            lt.UpdateAcListNum();
+            vRecorded.push_back(State(lt));
+        }
+        lt.StopRecording();
+    }
+    
+    // Replay into a fresh connection, LiveTraffic not needed any longer
+    XPLMStub::SetLTAvail(false);
+    LTAPIConnect lt;
+    bool bOK = lt.StartReplay(PATH);
+    if (!bOK)
+        printf("  could not replay %s\n", PATH);
+    for (int i = 0; bOK && i < NUM_CYCLES; i++) {
+        if (lt.isReplayAtEnd()) {
+            printf("  cycle %d: replay ended early\n", i);
+            bOK = false;
+            break;
+        }
+        lt.UpdateAcListNum();
+        const MapStateTy mapReplayed = State(lt);
+        int numDiff = std::abs(int(mapReplayed.size()) - int(vRecorded[size_t(i)].size()));
+        for (const auto& p: vRecorded[size_t(i)]) {
+            const auto iter = mapReplayed.find(p.first);
+            numDiff += iter == mapReplayed.end() || iter->second != p.second;
+        }
+        if (numDiff) {
+            printf("  cycle %d: %d aircraft differ from the recording\n", i, numDiff);
+            bOK = false;
+        }
+    }
+    if (bOK && !lt.isReplayAtEnd()) {
+        printf("  replay not at end after %d cycles\n", NUM_CYCLES);
+        bOK = false;
+    }
+    lt.StopReplay();
+    XPLMStub::SetLTAvail(true);
+    std::remove(PATH);
+    return bOK;
+}
+
+/// @brief Extrapolated positions must match the stub's tracks, but go no further than `MAX_EXTRAPOLATE_S` and never back
+static bool TestExtrapolate ()
+{
+    constexpr int NUM_AC = 500;
+    constexpr double DT_S = 5.0;
+    constexpr double MAX_S = LTAPIAircraft::MAX_EXTRAPOLATE_S;
+    constexpr double TOL_DEG = 1e-5;                // ~1m, stub and LTAPI differ in the order of updating lat and lon
+    constexpr double TOL_FT = 0.01;                 // stub multiplies vertical speed in `float`
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 61);
+    LTAPIConnect lt;
+    lt.EnableColumns();
+    lt.UpdateAcListNum();
+    
+    // Extrapolation of each aircraft at its own fetch time
+    auto Extra = [&lt](int k, double dt_s, double& lat, double& lon, double& alt_ft) {
+        const SPtrLTAPIAircraft& spAc = lt.getAcMapNum().at(XPLMStub::GetKey(k));
+        spAc->extrapolate(spAc->getBulkTime() +
+                          std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(dt_s)),
+                          lat, lon, alt_ft);
+    };
+    
+    struct PosTy { double lat, lon, alt_ft; };
+    std::vector<PosTy> vFetched(NUM_AC), vAtDt(NUM_AC), vAtMax(NUM_AC), vBeyond(NUM_AC), vBack(NUM_AC);
+    for (int k = 0; k < NUM_AC; k++) {
+        XPLMStub::GetPos(k, vFetched[size_t(k)].lat, vFetched[size_t(k)].lon, vFetched[size_t(k)].alt_ft);
+        Extra(k, DT_S,        vAtDt[size_t(k)].lat,   vAtDt[size_t(k)].lon,   vAtDt[size_t(k)].alt_ft);
+        Extra(k, MAX_S,       vAtMax[size_t(k)].lat,  vAtMax[size_t(k)].lon,  vAtMax[size_t(k)].alt_ft);
+        Extra(k, 3.0 * MAX_S, vBeyond[size_t(k)].lat, vBeyond[size_t(k)].lon, vBeyond[size_t(k)].alt_ft);
+        Extra(k, -DT_S,       vBack[size_t(k)].lat,   vBack[size_t(k)].lon,   vBack[size_t(k)].alt_ft);
+    }
+    
+    // Beyond the limit stays at the limit, backwards stays at the fetched position
+    for (int k = 0; k < NUM_AC; k++) {
+        const PosTy &at = vAtMax[size_t(k)], &beyond = vBeyond[size_t(k)];
+        const PosTy &fetched = vFetched[size_t(k)], &back = vBack[size_t(k)];
+        if (std::fabs(at.lat - beyond.lat) > 0.0 || std::fabs(at.lon - beyond.lon) > 0.0 ||
+            std::fabs(at.alt_ft - beyond.alt_ft) > 0.0 ||
+            std::fabs(fetched.lat - back.lat) > 0.0 || std::fabs(fetched.lon - back.lon) > 0.0 ||
+            std::fabs(fetched.alt_ft - back.alt_ft) > 0.0) {
+            printf("  aircraft %d: extrapolated beyond %.0fs or backwards\n", k, MAX_S);
+            return false;
+        }
+    }
+    
+    // Columns extrapolate the same
+    std::vector<double> vLat, vLon, vAlt;
+    const LTAPIAcColumns& cols = lt.getColumns();
+    cols.extrapolate(lt.getAcMapNum().begin()->second->getBulkTime() + std::chrono::seconds(int(3.0 * MAX_S)),
+                     vLat, vLon, vAlt);
+    for (size_t i = 0; i < cols.size(); i++) {
+        double lat, lon, alt_ft;
+        cols.ac[i]->extrapolate(cols.ac[i]->getBulkTime() + std::chrono::seconds(int(3.0 * MAX_S)), lat, lon, alt_ft);
+        if (std::fabs(vLat[i] - lat) > 0.0 || std::fabs(vLon[i] - lon) > 0.0 || std::fabs(vAlt[i] - alt_ft) > 0.0) {
+            printf("  row %zu: columns extrapolate differently\n", i);
+            return false;
+        }
+    }
+    
+    // Stub moves the fleet along the same tracks, first by DT_S, then up to MAX_S
+    for (const auto& step: { std::make_pair(DT_S, &vAtDt), std::make_pair(MAX_S, &vAtMax) }) {
+        XPLMStub::SetFleet(NUM_AC, 61);
+        XPLMStub::Step(float(step.first));
+        for (int k = 0; k < NUM_AC; k++) {
+            double lat, lon, alt_ft;
+            XPLMStub::GetPos(k, lat, lon, alt_ft);
+            const PosTy& ex = (*step.second)[size_t(k)];
+            // (the stub keeps altitudes within 1000..45000ft)
+            const bool bAltClamped = alt_ft <= 1000.0 || alt_ft >= 45000.0;
+            if (std::fabs(ex.lat - lat) > TOL_DEG || std::fabs(ex.lon - lon) > TOL_DEG ||
+                (!bAltClamped && std::fabs(ex.alt_ft - alt_ft) > TOL_FT)) {
+                printf("  aircraft %d after %.0fs: extrapolated %.6f/%.6f/%.1f, stub %.6f/%.6f/%.1f\n",
+                       k, step.first, ex.lat, ex.lon, ex.alt_ft, lat, lon, alt_ft);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// @brief Interpolation between two fetches must lie on the stub's tracks, attitudes slerped between samples
+static bool TestInterpolate ()
+{
+    constexpr int NUM_AC = 200;
+    constexpr double TOL_DEG = 1e-9;
+    constexpr double TOL_FT = 1e-6;
+    constexpr float TOL_ATT = 0.01f;
+    // attitudes at both fetches, rotations of more than 3.6° are slerped
+    const struct { float a[3], b[3]; bool bSingleAxis; } ATT[] = {
+        { {  10.0f,  0.0f,   0.0f }, {  50.0f,  0.0f,  0.0f }, true },
+        { { 350.0f,  0.0f,   0.0f }, {  30.0f,  0.0f,  0.0f }, true },      // across north
+        { {  90.0f,  0.0f,   0.0f }, {  90.0f, 40.0f,  0.0f }, true },
+        { { 180.0f,  0.0f, -30.0f }, { 180.0f,  0.0f, 30.0f }, true },
+        { { 100.0f,  5.0f,   0.0f }, { 102.0f,  5.0f,  0.0f }, true },      // small rotation: lerped
+        { {   0.0f,  0.0f,   0.0f }, {  90.0f, 20.0f, 60.0f }, false },     // along the shortest rotation
+    };
+    constexpr int NUM_ATT = int(sizeof(ATT) / sizeof(ATT[0]));
+    // Rotation angle between two attitudes, heading-pitch-roll as intrinsic z-y-x rotations
+    auto AngleDeg = [](const float a[3], const float b[3]) {
+        double q[2][4];
+        for (int j = 0; j < 2; j++) {
+            const float* att = j ? b : a;
+            const double h = att[0] * 3.14159265358979323846 / 360.0;
+            const double p = att[1] * 3.14159265358979323846 / 360.0;
+            const double r = att[2] * 3.14159265358979323846 / 360.0;
+            q[j][0] = std::cos(r) * std::cos(p) * std::cos(h) + std::sin(r) * std::sin(p) * std::sin(h);
+            q[j][1] = std::sin(r) * std::cos(p) * std::cos(h) - std::cos(r) * std::sin(p) * std::sin(h);
+            q[j][2] = std::cos(r) * std::sin(p) * std::cos(h) + std::sin(r) * std::cos(p) * std::sin(h);
+            q[j][3] = std::cos(r) * std::cos(p) * std::sin(h) - std::sin(r) * std::sin(p) * std::cos(h);
+        }
+        const double d = std::fabs(q[0][0]*q[1][0] + q[0][1]*q[1][1] + q[0][2]*q[1][2] + q[0][3]*q[1][3]);
+        return float(2.0 * std::acos(std::min(d, 1.0)) * 180.0 / 3.14159265358979323846);
+    };
+    auto DiffDeg = [](float a, float b) {
+        float d = std::fmod(a - b, 360.0f);
+        if (d > 180.0f) d -= 360.0f;
+        if (d < -180.0f) d += 360.0f;
+        return std::fabs(d);
+    };
+    
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 67);
+    LTAPIConnect lt;
+    lt.EnableInterpolation();
+    
+    // two fetches with known positions and attitudes
+    struct PosTy { double lat, lon, alt_ft; };
+    std::unordered_map<uint64_t, PosTy> mapPos[2];
+    for (int fetch = 0; fetch < 2; fetch++) {
+        if (fetch) {
+            XPLMStub::Step(2.0f);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        for (int k = 0; k < NUM_ATT; k++) {
+            const float* att = fetch ? ATT[k].b : ATT[k].a;
+            XPLMStub::SetAttitude(k, att[0], att[1], att[2]);
+        }
+        for (int k = 0; k < NUM_AC; k++) {
+            PosTy pos;
+            XPLMStub::GetPos(k, pos.lat, pos.lon, pos.alt_ft);
+            mapPos[fetch].emplace(XPLMStub::GetKey(k), pos);
+        }
+        lt.UpdateAcListNum();
+    }
+    
+    const LTAPIAcColumns& cols = lt.getColumns();
+    std::vector<LTAPIAcColumns::Pose> vPose;
+    for (size_t i = 0; i < cols.size(); i++) {
+        const LTAPIAcColumns::History& h = cols.hist[i];
+        if (h.num != 2) {
+            printf("  row %zu: %u samples, expected 2\n", i, unsigned(h.num));
+            return false;
+        }
+        const int64_t t0 = h.s[0].ts_ns, t1 = h.s[1].ts_ns;
+        const PosTy& p0 = mapPos[0].at(cols.key[i]);
+        const PosTy& p1 = mapPos[1].at(cols.key[i]);
+        int k = -1;
+        for (int j = 0; j < NUM_ATT; j++)
+            if (XPLMStub::GetKey(j) == cols.key[i])
+                k = j;
+        
+        // before, between, and after the samples
+        for (const double f: { -0.5, 0.25, 0.5, 1.5 }) {
+            const int64_t ts_ns = t0 + int64_t(f * double(t1 - t0));
+            cols.interpolate(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(ts_ns)), vPose);
+            const double fExp = std::min(std::max(double(ts_ns - t0) / double(t1 - t0), 0.0), 1.0);
+            const LTAPIAcColumns::Pose& pose = vPose[i];
+            if (std::fabs(pose.lat    - (p0.lat    + fExp * (p1.lat    - p0.lat)))    > TOL_DEG ||
+                std::fabs(pose.lon    - (p0.lon    + fExp * (p1.lon    - p0.lon)))    > TOL_DEG ||
+                std::fabs(pose.alt_ft - (p0.alt_ft + fExp * (p1.alt_ft - p0.alt_ft))) > TOL_FT) {
+                printf("  row %zu at %.2f: position not on the track\n", i, f);
+                return false;
+            }
+            if (k < 0)
+                continue;
+            const float* att = f < 0.0 ? ATT[k].a : f > 1.0 ? ATT[k].b : nullptr;
+            if (!att && !ATT[k].bSingleAxis) {
+                // slerp: the same share of the total rotation from the first and to the second sample
+                const float poseAtt[3] = { pose.heading, pose.pitch, pose.roll };
+                const float total = AngleDeg(ATT[k].a, ATT[k].b);
+                const float from  = AngleDeg(ATT[k].a, poseAtt);
+                const float to    = AngleDeg(poseAtt, ATT[k].b);
+                if (std::fabs(from - float(fExp) * total) > TOL_ATT * 5.0f ||
+                    std::fabs(to - float(1.0 - fExp) * total) > TOL_ATT * 5.0f) {
+                    printf("  attitude %d at %.2f: %.3f° from first, %.3f° to second of %.3f° total\n",
+                           k, f, from, to, total);
+                    return false;
+                }
+                continue;
+            }
+            float attExp[3];
+            if (!att) {
+                // single-axis rotations: slerp is linear in the angle
+                for (int a = 0; a < 3; a++) {
+                    float d = ATT[k].b[a] - ATT[k].a[a];
+                    if (d > 180.0f) d -= 360.0f;
+                    if (d < -180.0f) d += 360.0f;
+                    attExp[a] = ATT[k].a[a] + float(fExp) * d;
+                }
+                att = attExp;
+            }
+            if (DiffDeg(pose.heading, att[0]) > TOL_ATT ||
+                DiffDeg(pose.pitch,   att[1]) > TOL_ATT ||
+                DiffDeg(pose.roll,    att[2]) > TOL_ATT) {
+                printf("  attitude %d at %.2f: %.3f/%.3f/%.3f, expected %.3f/%.3f/%.3f\n",
+                       k, f, pose.heading, pose.pitch, pose.roll, att[0], att[1], att[2]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// @brief With a time budget, aircraft must only be removed once LiveTraffic no longer serves them
+/// @details LiveTraffic removing and adding aircraft while a sweep spans several calls
+///          shifts aircraft across the offset, at which the next call resumes.
+static bool TestBudgetRemoval ()
+{
+    constexpr int NUM_AC = 2000;
+    constexpr int NUM_CALLS = 4000;
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 11);
+    LTAPIConnect lt;
+    lt.usUpdateBudget = std::chrono::microseconds(1);   // effectively one bulk per call
+    VecLTAPIAircraft vecRemoved;
+    std::unordered_set<uint64_t> setServed;
+
+    uint64_t numRemoved = 0, numWrong = 0;
+    for (int i = 0; i < NUM_CALLS; i++) {
+        XPLMStub::Step(1.0f, 0.002f);
+        lt.UpdateAcListNumVec(&vecRemoved);
+        if (vecRemoved.empty())
+            continue;
+        // Which of the removed aircraft does LiveTraffic still serve?
+        setServed.clear();
+        for (int k = 0; k < XPLMStub::GetNumAc(); k++)
+            setServed.insert(XPLMStub::GetKey(k));
+        for (const SPtrLTAPIAircraft& spAc: vecRemoved)
+            if (setServed.count(spAc->getKeyNum()))
+                numWrong++;
+        numRemoved += vecRemoved.size();
+        vecRemoved.clear();
+    }
+
+    if (numRemoved == 0) {
+        printf("  no aircraft removed at all\n");
+        return false;
+    }
+    if (numWrong > 0) {
+        printf("  %llu of %llu removed aircraft are still served by LiveTraffic\n",
+               (unsigned long long)numWrong, (unsigned long long)numRemoved);
+        return false;
+    }
+    return true;
+}
+
+/// @brief With a time budget, multiplayer slot and camera aircraft must stay available during sweeps
+static bool TestBudgetCamera ()
+{
+    constexpr int NUM_AC = 3000;
+    constexpr int NUM_CALLS = 40;
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 17);
+    XPLMStub::SetMultiIdx(2900, 5);
+    XPLMStub::SetCamera(2950);
+    const uint64_t keySlot = XPLMStub::GetKey(2900);
+    const uint64_t keyCamera = XPLMStub::GetKey(2950);
+    LTAPIConnect lt;
+    lt.UpdateAcListNum();                               // complete sweep without budget
+    lt.usUpdateBudget = std::chrono::microseconds(1);   // then effectively one bulk per call
+    
+    int numWrong = 0;
+    for (int i = 0; i < NUM_CALLS; i++) {
+        XPLMStub::Step(1.0f);
+        lt.UpdateAcListNum();
+        const SPtrLTAPIAircraft spSlot = lt.getAcByMultIdx(5);
+        const SPtrLTAPIAircraft spCamera = lt.getAcInCameraView();
+        if (!spSlot || spSlot->getKeyNum() != keySlot ||
+            !spCamera || spCamera->getKeyNum() != keyCamera)
+            numWrong++;
+    }
+    XPLMStub::SetCamera(-1);
+    
+    if (numWrong > 0) {
+        printf("  slot or camera aircraft wrong in %d of %d calls\n", numWrong, NUM_CALLS);
+        return false;
+    }
+    return true;
+}
+
+/// @brief Snapshots must be sorted by key and contain exactly the aircraft of the map
+static bool TestSnapshot ()
+{
+    constexpr int NUM_AC = 1000;
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 19);
+    LTAPIConnect lt;
+    lt.EnableSnapshots();
+    
+    for (int i = 0; i < 20; i++) {
+        XPLMStub::Step(1.0f, 0.02f);
+        lt.UpdateAcListNum();
+        const SPtrLTAPISnapshot spSnap = lt.getSnapshot();
+        if (!spSnap || spSnap->size() != lt.getAcMapNum().size()) {
+            printf("  call %d: snapshot size differs from map\n", i);
+            return false;
+        }
+        for (size_t k = 1; k < spSnap->size(); k++)
+            if (spSnap->vBulk[k-1].keyNum >= spSnap->vBulk[k].keyNum) {
+                printf("  call %d: snapshot not sorted by key\n", i);
+                return false;
+            }
+        for (const MapLTAPIAircraftNum::value_type& p: lt.getAcMapNum()) {
+            const long idx = spSnap->find(p.first);
+            if (idx < 0 || std::fabs(spSnap->vBulk[size_t(idx)].lat - p.second->getLat()) > 0.0 ||
+                spSnap->vInfo[size_t(idx)].keyNum != p.first) {
+                printf("  call %d: aircraft %llx not found in snapshot\n", i, (unsigned long long)p.first);
+                return false;
+            }
+        }
+        if (spSnap->find(0) >= 0 || spSnap->find(UINT64_MAX) >= 0) {
+            printf("  call %d: found unknown key in snapshot\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Level of detail must refresh each tier's numeric data within its interval, also when texts are fetched
+static bool TestLODTiers ()
+{
+    constexpr int NUM_AC = 3000;
+    constexpr int NUM_CALLS = 32;
+    constexpr int FULL_INTVL = 8;
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetFleet(NUM_AC, 23);
+    LTAPIConnect lt;
+    lt.EnableLOD(true, std::vector<LTAPIConnect::LODTier>(), FULL_INTVL);  // 25 nm: 1, 75 nm: 2, 150 nm: 4
+    lt.sPeriodExpsv = std::chrono::seconds(0);          // texts in every call, which must not count as fetched
+    lt.UpdateAcListNum();                               // initial full fetch
+    
+    std::unordered_map<uint64_t,int> mapLastFetch;      // call, in which an aircraft was last fetched
+    int numWrong = 0;
+    for (int i = 1; i <= NUM_CALLS; i++) {
+        XPLMStub::Step(0.0f);                           // aircraft keep their tier
+        lt.UpdateAcListNum();
+        
+        size_t numFetched = 0, numFar = 0, numFarFetched = 0;
+        for (const MapLTAPIAircraftNum::value_type& p: lt.getAcMapNum()) {
+            const float dist = p.second->getDistNm();
+            const int intvl = dist < 25.0f ? 1 : dist < 75.0f ? 2 : dist < 150.0f ? 4 : FULL_INTVL;
+            int& last = mapLastFetch[p.first];
+            if (p.second->isUpdated()) {
+                numFetched++;
+                last = i;
+            }
+            else if (i - last >= intvl)                 // not fetched within its interval
+                numWrong++;
+            if (intvl == FULL_INTVL) {
+                numFar++;
+                numFarFetched += p.second->isUpdated();
+            }
+        }
+        
+        // Only every FULL_INTVL-th call fetches all aircraft,
+        // in between most aircraft beyond the farthest tier are not fetched
+        const bool bFull = i % FULL_INTVL == 0;
+        if (bFull != (numFetched == lt.getAcMapNum().size()) ||
+            (!bFull && numFarFetched * 2 > numFar)) {
+            printf("  call %d: %zu of %zu aircraft fetched, %zu of %zu beyond the farthest tier\n",
+                   i, numFetched, lt.getAcMapNum().size(), numFarFetched, numFar);
+            return false;
+        }
+    }
+    
+    if (numWrong > 0) {
+        printf("  %d times an aircraft was not fetched within its tier's interval\n", numWrong);
+        return false;
+    }
+    return true;
+}
+
+/// @brief The `x/y/z` columns must match `XPLMWorldToLocal`, also after X-Plane moved its local origin
+static bool TestLocalCoords ()
+{
+    constexpr int NUM_AC = 500;
+    constexpr double MAX_ERR_M = 0.05;
+    XPLMStub::SetLTAvail(true);
+    XPLMStub::SetLocalOrigin(50.0, 8.5);
+    XPLMStub::SetFleet(NUM_AC, 13);
+    LTAPIConnect lt;
+    lt.EnableColumns();
+    lt.UpdateAcListNum();
+    
+    // Compares all rows with X-Plane's conversion
+    auto Check = [&lt](const char* where) -> bool
+    {
+        const LTAPIAcColumns& cols = lt.getColumns();
+        double maxErr = 0.0;
+        for (size_t i = 0; i < cols.size(); i++) {
+            double x, y, z;
+            XPLMWorldToLocal(cols.lat[i], cols.lon[i], cols.alt_ft[i] * 0.3048, &x, &y, &z);
+            maxErr = std::max({ maxErr, std::fabs(x - cols.x[i]), std::fabs(y - cols.y[i]), std::fabs(z - cols.z[i]) });
+        }
+        if (cols.size() != size_t(NUM_AC) || maxErr > MAX_ERR_M) {
+            printf("  %s: %zu rows, max deviation %.3f m\n", where, cols.size(), maxErr);
+            return false;
+        }
+        return true;
+    };
+    
+    bool bOK = true;
+    lt.UpdateLocalCoords();
+    bOK &= Check("initial origin");
+    // X-Plane moves its local origin, incl. to places close to and at a pole
+    const double ORIGINS[][2] = { { 51.5, 10.0 }, { -33.9, 151.2 }, { 89.99, 0.0 }, { 90.0, 0.0 }, { -90.0, 45.0 } };
+    for (const auto& o: ORIGINS) {
+        XPLMStub::SetLocalOrigin(o[0], o[1]);
+        if (lt.UpdateLocalCoords() != size_t(NUM_AC)) {
+            printf("  origin %.2f/%.2f: not all rows converted again\n", o[0], o[1]);
+            bOK = false;
+        }
+        char where[50];
+        snprintf(where, sizeof(where), "origin %.2f/%.2f", o[0], o[1]);
+        bOK &= Check(where);
+    }
+    XPLMStub::SetLocalOrigin(50.0, 8.5);
+    return bOK;
+}
+
+/// All tests with their names
+static const struct {
+    const char* name;                   ///< test name, can be passed as argument
+    bool (*pfTest)();                   ///< test function
+} TESTS[] = {
+    { "NoAlloc",            TestNoAlloc },
+    { "HintCache",          TestHintCache },
+    { "ExpsvRefresh",       TestExpsvRefresh },
+    { "Events",             TestEvents },
+    { "Columns",            TestColumns },
+    { "Spatial",            TestSpatial },
+    { "Grid",               TestGrid },
+    { "TextIndex",          TestTextIndex },
+    { "Replay",             TestReplay },
+    { "Extrapolate",        TestExtrapolate },
+    { "Interpolate",        TestInterpolate },
+    { "BudgetRemoval",      TestBudgetRemoval },
+    { "BudgetCamera",       TestBudgetCamera },
+    { "Snapshot",           TestSnapshot },
+    { "LODTiers",           TestLODTiers },
+    { "LocalCoords",        TestLocalCoords },
+};
+
+int main (int argc, char* argv[])
+{
+    int numFailed = 0;
+    for (const auto& t: TESTS) {
+        // only run requested tests, if any were requested
+        bool bRun = argc <= 1;
+        for (int i = 1; i < argc && !bRun; i++)
+            bRun = !strcmp(argv[i], t.name);
+        if (!bRun)
+            continue;
+
+        const bool bOK = t.pfTest();
+        printf("%-20s %s\n", t.name, bOK ? "passed" : "FAILED");
+        fflush(stdout);
+        if (!bOK)
+            numFailed++;
+    }
+    return numFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,656 @@
+/// @file       XPLMStub.cpp
+/// @brief      Headless stand-in for the XPLM library
+/// @details    Implements dataRef handling, LiveTraffic's dataRefs serving
+///             a synthetic fleet, and a simple local coordinate system.
+/// @see        https://twinfan.github.io/LTAPI/
+/// @author     Birger Hoppe
+/// @copyright  (c) 2019-2025 Birger Hoppe
+/// @copyright  Permission is hereby granted, free of charge, to any person obtaining a
+///             copy of this software and associated documentation files (the "Software"),
+///             to deal in the Software without restriction, including without limitation
+///             the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///             and/or sell copies of the Software, and to permit persons to whom the
+///             Software is furnished to do so, subject to the following conditions:\n
+///             The above copyright notice and this permission notice shall be included in
+///             all copies or substantial portions of the Software.\n
+///             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///             IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///             FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///             AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///             LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///             OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+///             THE SOFTWARE.
+
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_set>
+#include <numeric>
+#include <memory>
+#include <algorithm>
+
+#include "XPLMStub.h"
+#include "LTAPI.h"
+
+#include "XPLMDataAccess.h"
+#include "XPLMGraphics.h"
+#include "XPLMPlugin.h"
+
+//
+// MARK: DataRef registry
+//
+
+/// One dataRef, either registered via accessors or shared data
+struct StubDataRef {
+    std::string         name;                       ///< dataRef's name
+    XPLMDataTypeID      types       = xplmType_Unknown; ///< supported types
+    bool                bValid      = true;         ///< `false` after unregistering
+    XPLMGetDatai_f      pfGeti      = nullptr;      ///< int read accessor
+    XPLMSetDatai_f      pfSeti      = nullptr;      ///< int write accessor
+    XPLMGetDataf_f      pfGetf      = nullptr;      ///< float read accessor
+    XPLMSetDataf_f      pfSetf      = nullptr;      ///< float write accessor
+    XPLMGetDatab_f      pfGetb      = nullptr;      ///< data read accessor
+    void*               readRefcon  = nullptr;      ///< refcon passed to read accessors
+    void*               writeRefcon = nullptr;      ///< refcon passed to write accessors
+    // shared data
+    bool                bShared     = false;        ///< is shared data, ie. value stored here?
+    int                 iVal        = 0;            ///< shared int value
+    float               fVal        = 0.0f;         ///< shared float value
+    /// notification callbacks of shared data
+    std::vector<std::pair<XPLMDataChanged_f,void*>> vNotify;
+};
+
+/// All dataRefs, never freed, so that handles stay valid
+static std::map<std::string,std::unique_ptr<StubDataRef>>& GetRegistry ()
+{
+    static std::map<std::string,std::unique_ptr<StubDataRef>> mapDR;
+    return mapDR;
+}
+
+/// Finds or creates a dataRef by name
+static StubDataRef* GetOrCreate (const char* inDataName)
+{
+    std::unique_ptr<StubDataRef>& p = GetRegistry()[inDataName];
+    if (!p) {
+        p.reset(new StubDataRef);
+        p->name = inDataName;
+        p->bValid = false;
+    }
+    return p.get();
+}
+
+/// Notify all shared data callbacks
+static void Notify (StubDataRef* pDR)
+{
+    for (const auto& n: pDR->vNotify)
+        if (n.first)
+            n.first(n.second);
+}
+
+XPLMDataRef XPLMFindDataRef (const char* inDataRefName)
+{
+    auto iter = GetRegistry().find(inDataRefName);
+    if (iter == GetRegistry().end() || !iter->second->bValid)
+        return nullptr;
+    return iter->second.get();
+}
+
+XPLMDataTypeID XPLMGetDataRefTypes (XPLMDataRef inDataRef)
+{
+    const StubDataRef* pDR = (const StubDataRef*)inDataRef;
+    return pDR && pDR->bValid ? pDR->types : xplmType_Unknown;
+}
+
+int XPLMGetDatai (XPLMDataRef inDataRef)
+{
+    StubDataRef* pDR = (StubDataRef*)inDataRef;
+    if (!pDR || !pDR->bValid) return 0;
+    if (pDR->pfGeti) return pDR->pfGeti(pDR->readRefcon);
+    return pDR->iVal;
+}
+
+void XPLMSetDatai (XPLMDataRef inDataRef, int inValue)
+{
+    StubDataRef* pDR = (StubDataRef*)inDataRef;
+    if (!pDR || !pDR->bValid) return;
+    if (pDR->pfSeti) { pDR->pfSeti(pDR->writeRefcon, inValue); return; }
+    if (pDR->bShared) { pDR->iVal = inValue; Notify(pDR); }
+}
+
+float XPLMGetDataf (XPLMDataRef inDataRef)
+{
+    StubDataRef* pDR = (StubDataRef*)inDataRef;
+    if (!pDR || !pDR->bValid) return 0.0f;
+    if (pDR->pfGetf) return pDR->pfGetf(pDR->readRefcon);
+    return pDR->fVal;
+}
+
+void XPLMSetDataf (XPLMDataRef inDataRef, float inValue)
+{
+    StubDataRef* pDR = (StubDataRef*)inDataRef;
+    if (!pDR || !pDR->bValid) return;
+    if (pDR->pfSetf) { pDR->pfSetf(pDR->writeRefcon, inValue); return; }
+    if (pDR->bShared) { pDR->fVal = inValue; Notify(pDR); }
+}
+
+int XPLMGetDatab (XPLMDataRef inDataRef, void* outValue, int inOffset, int inMaxBytes)
+{
+    StubDataRef* pDR = (StubDataRef*)inDataRef;
+    if (!pDR || !pDR->bValid || !pDR->pfGetb) return 0;
+    return pDR->pfGetb(pDR->readRefcon, outValue, inOffset, inMaxBytes);
+}
+
+XPLMDataRef XPLMRegisterDataAccessor (const char* inDataName,
+                                      XPLMDataTypeID inDataType,
+                                      int /*inIsWritable*/,
+                                      XPLMGetDatai_f inReadInt,
+                                      XPLMSetDatai_f inWriteInt,
+                                      XPLMGetDataf_f inReadFloat,
+                                      XPLMSetDataf_f inWriteFloat,
+                                      XPLMGetDatad_f,
+                                      XPLMSetDatad_f,
+                                      XPLMGetDatavi_f,
+                                      XPLMSetDatavi_f,
+                                      XPLMGetDatavf_f,
+                                      XPLMSetDatavf_f,
+                                      XPLMGetDatab_f inReadData,
+                                      XPLMSetDatab_f,
+                                      void* inReadRefcon,
+                                      void* inWriteRefcon)
+{
+    StubDataRef* pDR = GetOrCreate(inDataName);
+    pDR->types      = inDataType;
+    pDR->bValid     = true;
+    pDR->pfGeti     = inReadInt;
+    pDR->pfSeti     = inWriteInt;
+    pDR->pfGetf     = inReadFloat;
+    pDR->pfSetf     = inWriteFloat;
+    pDR->pfGetb     = inReadData;
+    pDR->readRefcon = inReadRefcon;
+    pDR->writeRefcon= inWriteRefcon;
+    return pDR;
+}
+
+void XPLMUnregisterDataAccessor (XPLMDataRef inDataRef)
+{
+    StubDataRef* pDR = (StubDataRef*)inDataRef;
+    if (pDR) pDR->bValid = false;
+}
+
+int XPLMShareData (const char* inDataName, XPLMDataTypeID inDataType,
+                   XPLMDataChanged_f inNotificationFunc, void* inNotificationRefcon)
+{
+    StubDataRef* pDR = GetOrCreate(inDataName);
+    if (pDR->bValid && pDR->types != inDataType)
+        return 0;
+    pDR->types = inDataType;
+    pDR->bValid = pDR->bShared = true;
+    if (inNotificationFunc)
+        pDR->vNotify.emplace_back(inNotificationFunc, inNotificationRefcon);
+    return 1;
+}
+
+int XPLMUnshareData (const char* inDataName, XPLMDataTypeID inDataType,
+                     XPLMDataChanged_f inNotificationFunc, void* inNotificationRefcon)
+{
+    StubDataRef* pDR = GetOrCreate(inDataName);
+    if (!pDR->bShared || pDR->types != inDataType)
+        return 0;
+    auto iter = std::find(pDR->vNotify.begin(), pDR->vNotify.end(),
+                          std::make_pair(inNotificationFunc, inNotificationRefcon));
+    if (iter != pDR->vNotify.end())
+        pDR->vNotify.erase(iter);
+    return 1;
+}
+
+//
+// MARK: Plugins, Graphics
+//
+
+/// LiveTraffic's plugin signature
+#define LT_PLUGIN_SIGNATURE     "TwinFan.plugin.LiveTraffic"
+
+namespace XPLMStub {
+    /// Is LiveTraffic available?
+    static bool gbLTAvail = true;
+    /// Origin of local coordinates [°]
+    static double gLocalLat = 50.0;
+    /// Origin of local coordinates [°]
+    static double gLocalLon = 8.5;
+}
+
+XPLMPluginID XPLMFindPluginBySignature (const char* inSignature)
+{
+    return XPLMStub::gbLTAvail && !strcmp(inSignature, LT_PLUGIN_SIGNATURE) ? 1 : XPLM_NO_PLUGIN_ID;
+}
+
+void XPLMSendMessageToPlugin (XPLMPluginID, int, void*)
+{
+    // no other plugins to talk to
+}
+
+/// Spherical earth, local coordinates are a tangent plane in the origin:
+/// x points east, y up, z south
+void XPLMWorldToLocal (double inLatitude, double inLongitude, double inAltitude,
+                       double* outX, double* outY, double* outZ)
+{
+    constexpr double R = 6378145.0;
+    constexpr double D2R = 3.14159265358979323846 / 180.0;
+    const double lat0 = XPLMStub::gLocalLat * D2R, lon0 = XPLMStub::gLocalLon * D2R;
+    const double lat  = inLatitude * D2R,  lon  = inLongitude * D2R;
+    const double r = R + inAltitude;
+    // ECEF of point relative to ECEF of origin
+    const double dx = r * std::cos(lat) * std::cos(lon) - R * std::cos(lat0) * std::cos(lon0);
+    const double dy = r * std::cos(lat) * std::sin(lon) - R * std::cos(lat0) * std::sin(lon0);
+    const double dz = r * std::sin(lat)                 - R * std::sin(lat0);
+    // rotate into east/north/up
+    const double e = -std::sin(lon0) * dx + std::cos(lon0) * dy;
+    const double n = -std::sin(lat0) * std::cos(lon0) * dx - std::sin(lat0) * std::sin(lon0) * dy + std::cos(lat0) * dz;
+    const double u =  std::cos(lat0) * std::cos(lon0) * dx + std::cos(lat0) * std::sin(lon0) * dy + std::sin(lat0) * dz;
+    *outX = e;
+    *outY = u;
+    *outZ = -n;
+}
+
+/// Inverse of XPLMWorldToLocal()
+void XPLMLocalToWorld (double inX, double inY, double inZ,
+                       double* outLatitude, double* outLongitude, double* outAltitude)
+{
+    constexpr double R = 6378145.0;
+    constexpr double D2R = 3.14159265358979323846 / 180.0;
+    const double lat0 = XPLMStub::gLocalLat * D2R, lon0 = XPLMStub::gLocalLon * D2R;
+    const double e = inX, u = inY, n = -inZ;
+    // rotate back from east/north/up into ECEF, add ECEF of origin
+    const double x = -std::sin(lon0) * e - std::sin(lat0) * std::cos(lon0) * n + std::cos(lat0) * std::cos(lon0) * u
+                     + R * std::cos(lat0) * std::cos(lon0);
+    const double y =  std::cos(lon0) * e - std::sin(lat0) * std::sin(lon0) * n + std::cos(lat0) * std::sin(lon0) * u
+                     + R * std::cos(lat0) * std::sin(lon0);
+    const double z =  std::cos(lat0) * n + std::sin(lat0) * u + R * std::sin(lat0);
+    const double r = std::sqrt(x*x + y*y + z*z);
+    *outLatitude  = std::asin(z / r) / D2R;
+    *outLongitude = std::atan2(y, x) / D2R;
+    *outAltitude  = r - R;
+}
+
+//
+// MARK: Synthetic LiveTraffic fleet
+//
+
+namespace XPLMStub {
+
+/// The fleet as LiveTraffic would have it, sorted by key like LiveTraffic's map
+struct FleetTy {
+    std::vector<LTAPIAircraft::LTAPIBulkData>       vBulk;      ///< numeric data
+    std::vector<LTAPIAircraft::LTAPIBulkInfoTexts>  vInfo;      ///< texts
+    std::unordered_set<uint64_t>                    setKeys;    ///< all keys ever used, never reused, so that a key identifies one aircraft
+    uint32_t    rnd         = 1;        ///< state of pseudo-random generator
+    uint64_t    serial      = 0;        ///< serial number of last created aircraft
+    double      churnCarry  = 0.0;      ///< fractional aircraft not yet replaced
+    size_t      sizeQuick   = sizeof(LTAPIAircraft::LTAPIBulkData);      ///< struct size negotiated by LTAPI
+    size_t      sizeExpsv   = sizeof(LTAPIAircraft::LTAPIBulkInfoTexts); ///< struct size negotiated by LTAPI
+    Counters    cnt;                    ///< served data counters
+};
+
+/// The one fleet
+static FleetTy gFleet;
+
+/// Simple xorshift pseudo-random generator
+static uint32_t Rnd ()
+{
+    uint32_t& x = gFleet.rnd;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return x;
+}
+
+/// Random number in [lo..hi)
+static double RndRange (double lo, double hi)
+{
+    return lo + (hi - lo) * (double(Rnd()) / 4294967296.0);
+}
+
+/// Compute bearing and distance to the camera, which sits at the local origin
+static void CalcDist (LTAPIAircraft::LTAPIBulkData& b)
+{
+    const double dLat = (b.lat - gLocalLat) * 60.0;
+    const double dLon = (b.lon - gLocalLon) * 60.0 * std::cos(gLocalLat * 3.14159265358979323846 / 180.0);
+    b.dist_nm = float(std::sqrt(dLat*dLat + dLon*dLon));
+    b.bearing = float(std::fmod(std::atan2(dLon, dLat) * 180.0 / 3.14159265358979323846 + 360.0, 360.0));
+}
+
+/// Copy a string into a fixed char array
+template <size_t N>
+static void SetStr (char (&dst)[N], const std::string& s)
+{
+    const size_t len = std::min(s.size(), N-1);
+    memcpy(dst, s.data(), len);
+    memset(dst + len, 0, N - len);
+}
+
+/// Create one new aircraft and append it, call SortFleet() afterwards
+static void AddAc ()
+{
+    static const char* MDL[][4] = {
+        { "A320", "Airbus",  "A320-214",      "L2J" },
+        { "B738", "Boeing",  "737-8AS",       "L2J" },
+        { "A359", "Airbus",  "A350-941",      "L2J" },
+        { "C172", "Cessna",  "172S Skyhawk",  "L1P" },
+        { "E190", "Embraer", "ERJ 190-100",   "L2J" },
+    };
+    static const char* APT[] = { "EDDF", "EDDM", "EGLL", "LFPG", "LEMD", "LIRF", "EHAM", "LOWW" };
+    static const char* OP[][2] = {
+        { "DLH", "Lufthansa" }, { "RYR", "Ryanair" }, { "BAW", "British Airways" }, { "AFR", "Air France" },
+    };
+
+    // find a unique key
+    uint64_t key = 0;
+    do {
+        key = 0x100000 + (Rnd() % 0xEFFFFF);
+    } while (!gFleet.setKeys.insert(key).second);
+    const uint64_t serial = ++gFleet.serial;
+
+    LTAPIAircraft::LTAPIBulkData b;
+    b.keyNum    = key;
+    b.lat       = RndRange(gLocalLat - 3.0, gLocalLat + 3.0);
+    b.lon       = RndRange(gLocalLon - 4.5, gLocalLon + 4.5);
+    b.bits.onGnd = Rnd() % 10 == 0;
+    b.alt_ft    = b.bits.onGnd ? 350.0 : RndRange(1000.0, 39000.0);
+    b.lat_f     = float(b.lat);
+    b.lon_f     = float(b.lon);
+    b.alt_ft_f  = float(b.alt_ft);
+    b.heading   = float(RndRange(0.0, 360.0));
+    b.track     = b.heading;
+    b.speed_kt  = b.bits.onGnd ? float(RndRange(0.0, 20.0)) : float(RndRange(120.0, 480.0));
+    b.vsi_ft    = b.bits.onGnd ? 0.0f : float(RndRange(-1500.0, 1500.0));
+    b.terrainAlt_ft = 350.0f;
+    b.height_ft = float(b.alt_ft) - b.terrainAlt_ft;
+    b.gear      = b.bits.onGnd ? 1.0f : 0.0f;
+    b.bits.phase = b.bits.onGnd ? LTAPIAircraft::FPH_TAXI : LTAPIAircraft::FPH_CRUISE;
+    b.bits.nav  = true;
+    b.bits.bcn  = true;
+    b.bits.strb = !b.bits.onGnd;
+    CalcDist(b);
+
+    LTAPIAircraft::LTAPIBulkInfoTexts t;
+    t.keyNum = key;
+    const auto& mdl = MDL[Rnd() % (sizeof(MDL)/sizeof(MDL[0]))];
+    const auto& op  = OP[Rnd() % (sizeof(OP)/sizeof(OP[0]))];
+    const std::string num = std::to_string(100 + serial % 9900);
+    SetStr(t.registration,  "D-A" + std::string(1, char('A' + serial % 26)) + char('A' + (serial / 26) % 26) + char('A' + (serial / 676) % 26));
+    SetStr(t.modelIcao,     mdl[0]);
+    SetStr(t.acClass,       mdl[3]);
+    SetStr(t.wtc,           "M");
+    SetStr(t.opIcao,        op[0]);
+    SetStr(t.man,           mdl[1]);
+    SetStr(t.model,         mdl[2]);
+    SetStr(t.catDescr,      "Synthetic test aircraft");
+    SetStr(t.op,            op[1]);
+    SetStr(t.callSign,      std::string(op[0]) + num);
+    SetStr(t.squawk,        std::to_string(1000 + serial % 6777));
+    SetStr(t.flightNumber,  std::string(op[0]).substr(0,2) + num);
+    SetStr(t.origin,        APT[Rnd() % (sizeof(APT)/sizeof(APT[0]))]);
+    SetStr(t.destination,   APT[Rnd() % (sizeof(APT)/sizeof(APT[0]))]);
+    SetStr(t.trackedBy,     "XPLMStub");
+    SetStr(t.cslModel,      std::string("Stub/") + mdl[0] + "_" + op[0]);
+
+    gFleet.vBulk.push_back(b);
+    gFleet.vInfo.push_back(t);
+}
+
+/// Sort the fleet by key, like LiveTraffic's map is sorted
+static void SortFleet ()
+{
+    std::vector<size_t> vIdx(gFleet.vBulk.size());
+    std::iota(vIdx.begin(), vIdx.end(), size_t(0));
+    std::sort(vIdx.begin(), vIdx.end(), [](size_t a, size_t b)
+              { return gFleet.vBulk[a].keyNum < gFleet.vBulk[b].keyNum; });
+    std::vector<LTAPIAircraft::LTAPIBulkData> vBulk;
+    std::vector<LTAPIAircraft::LTAPIBulkInfoTexts> vInfo;
+    vBulk.reserve(vIdx.size());
+    vInfo.reserve(vIdx.size());
+    for (size_t i: vIdx) {
+        vBulk.push_back(gFleet.vBulk[i]);
+        vInfo.push_back(gFleet.vInfo[i]);
+    }
+    gFleet.vBulk.swap(vBulk);
+    gFleet.vInfo.swap(vInfo);
+}
+
+/// Serves `livetraffic/bulk/quick` and `livetraffic/bulk/expensive` the way LiveTraffic does
+static int GetBulk (void* inRefcon, void* outData, int inOffset, int inNumBytes)
+{
+    const bool bQuick = inRefcon == nullptr;
+    size_t& sizeReq = bQuick ? gFleet.sizeQuick : gFleet.sizeExpsv;
+    const size_t sizeLT = bQuick ? sizeof(LTAPIAircraft::LTAPIBulkData) : sizeof(LTAPIAircraft::LTAPIBulkInfoTexts);
+    
+    // Size negotiation: LTAPI tells its struct size, we return ours
+    if (!outData) {
+        sizeReq = size_t(inNumBytes);
+        return int(sizeLT);
+    }
+    if (!sizeReq || inOffset < 0 || inNumBytes <= 0)
+        return 0;
+    
+    // Which aircraft are requested?
+    const size_t first = size_t(inOffset) / sizeReq;
+    const size_t end   = std::min(first + size_t(inNumBytes) / sizeReq, gFleet.vBulk.size());
+    const size_t copy  = std::min(sizeReq, sizeLT);
+    char* pOut = (char*)outData;
+    for (size_t i = first; i < end; ++i, pOut += sizeReq) {
+        if (bQuick) memcpy(pOut, &gFleet.vBulk[i], copy);
+        else        memcpy(pOut, &gFleet.vInfo[i], copy);
+    }
+    
+    // statistics
+    const size_t bytes = first < end ? (end - first) * sizeReq : 0;
+    gFleet.cnt.numGetDatab++;
+    (bQuick ? gFleet.cnt.bytesQuick : gFleet.cnt.bytesExpsv) += bytes;
+    return int(bytes);
+}
+
+/// Integer dataRefs LiveTraffic provides
+enum IntDRTy : intptr_t {
+    DR_VER_NR = 0, DR_VER_DATE, DR_AC_DISPLAYED, DR_AC_NUM, DR_AI_CONTROLLED, DR_SIM_DATE, DR_SIM_TIME
+};
+
+/// Serves LiveTraffic's integer dataRefs
+static int GetInt (void* inRefcon)
+{
+    switch (IntDRTy(intptr_t(inRefcon))) {
+        case DR_VER_NR:         return 40101;
+        case DR_VER_DATE:       return 20250101;
+        case DR_AC_DISPLAYED:   return gbLTAvail ? 1 : 0;
+        case DR_AC_NUM:         return gbLTAvail ? int(gFleet.vBulk.size()) : 0;
+        case DR_AI_CONTROLLED:  return 0;
+        case DR_SIM_DATE:       return 20250101;
+        case DR_SIM_TIME:       return 120000;
+    }
+    return 0;
+}
+
+/// Register all of LiveTraffic's dataRefs
+static void RegisterLTDataRefs ()
+{
+    static bool bRegistered = false;
+    if (bRegistered) return;
+    bRegistered = true;
+    
+    const struct { const char* name; IntDRTy id; } INT_DR[] = {
+        { "livetraffic/ver/nr",                 DR_VER_NR },
+        { "livetraffic/ver/date",               DR_VER_DATE },
+        { "livetraffic/cfg/aircrafts_displayed",DR_AC_DISPLAYED },
+        { "livetraffic/ac/num",                 DR_AC_NUM },
+        { "livetraffic/cfg/ai_controlled",      DR_AI_CONTROLLED },
+        { "livetraffic/sim/date",               DR_SIM_DATE },
+        { "livetraffic/sim/time",               DR_SIM_TIME },
+    };
+    for (const auto& dr: INT_DR)
+        XPLMRegisterDataAccessor(dr.name, xplmType_Int, 0,
+                                 GetInt, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                 nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                 (void*)intptr_t(dr.id), nullptr);
+    XPLMRegisterDataAccessor("livetraffic/bulk/quick", xplmType_Data, 0,
+                             nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                             nullptr, nullptr, nullptr, nullptr, GetBulk, nullptr,
+                             nullptr, nullptr);
+    XPLMRegisterDataAccessor("livetraffic/bulk/expensive", xplmType_Data, 0,
+                             nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                             nullptr, nullptr, nullptr, nullptr, GetBulk, nullptr,
+                             (void*)&gFleet, nullptr);
+    XPLMShareData("sim/multiplayer/camera/modeS_id", xplmType_Int, nullptr, nullptr);
+    XPLMShareData("sim/multiplayer/camera/tcas_idx", xplmType_Int, nullptr, nullptr);
+}
+
+// (Re)Creates a synthetic fleet of `numAc` aircraft
+void SetFleet (int numAc, uint32_t seed)
+{
+    RegisterLTDataRefs();
+    gFleet.vBulk.clear();
+    gFleet.vInfo.clear();
+    gFleet.setKeys.clear();
+    gFleet.rnd = seed ? seed : 1;
+    gFleet.churnCarry = 0.0;
+    gFleet.vBulk.reserve(size_t(numAc));
+    gFleet.vInfo.reserve(size_t(numAc));
+    for (int i = 0; i < numAc; ++i)
+        AddAc();
+    SortFleet();
+}
+
+// Moves the origin of local coordinates
+void SetLocalOrigin (double lat, double lon)
+{
+    gLocalLat = lat;
+    gLocalLon = lon;
+}
+
+// Moves the fleet forward in time and replaces a share of aircraft
+void Step (float dt, float churn)
+{
+    constexpr double D2R = 3.14159265358979323846 / 180.0;
+    for (LTAPIAircraft::LTAPIBulkData& b: gFleet.vBulk) {
+        const double dist_nm = b.speed_kt * dt / 3600.0;
+        b.lat += dist_nm / 60.0 * std::cos(b.track * D2R);
+        b.lon += dist_nm / 60.0 * std::sin(b.track * D2R) / std::cos(b.lat * D2R);
+        if (!b.bits.onGnd)
+            b.alt_ft = std::max(1000.0, std::min(45000.0, b.alt_ft + b.vsi_ft * dt / 60.0));
+        b.lat_f    = float(b.lat);
+        b.lon_f    = float(b.lon);
+        b.alt_ft_f = float(b.alt_ft);
+        b.height_ft = float(b.alt_ft) - b.terrainAlt_ft;
+        CalcDist(b);
+    }
+    
+    // Replace a share of aircraft
+    gFleet.churnCarry += double(gFleet.vBulk.size()) * double(churn);
+    if (gFleet.churnCarry < 1.0 || gFleet.vBulk.empty())
+        return;
+    const size_t numChurn = std::min(size_t(gFleet.churnCarry), gFleet.vBulk.size());
+    gFleet.churnCarry -= double(numChurn);
+    
+    // mark aircraft for removal by moving them to the end
+    size_t n = gFleet.vBulk.size();
+    for (size_t c = 0; c < numChurn; ++c, --n) {
+        const size_t i = Rnd() % n;
+        std::swap(gFleet.vBulk[i], gFleet.vBulk[n-1]);
+        std::swap(gFleet.vInfo[i], gFleet.vInfo[n-1]);
+    }
+    gFleet.vBulk.resize(n);
+    gFleet.vInfo.resize(n);
+    
+    // add the same number of new aircraft and restore order
+    for (size_t c = 0; c < numChurn; ++c)
+        AddAc();
+    SortFleet();
+}
+
+// Number of aircraft currently in the fleet
+int GetNumAc ()
+{
+    return int(gFleet.vBulk.size());
+}
+
+// Key of aircraft at position `i`
+uint64_t GetKey (int i)
+{
+    return 0 <= i && size_t(i) < gFleet.vBulk.size() ? gFleet.vBulk[size_t(i)].keyNum : 0;
+}
+
+// Position of aircraft at position `i`
+void GetPos (int i, double& lat, double& lon, double& alt_ft)
+{
+    lat = lon = alt_ft = 0.0;
+    if (0 <= i && size_t(i) < gFleet.vBulk.size()) {
+        const LTAPIAircraft::LTAPIBulkData& b = gFleet.vBulk[size_t(i)];
+        lat     = b.lat;
+        lon     = b.lon;
+        alt_ft  = b.alt_ft;
+    }
+}
+
+// Call sign of aircraft at position `i` as served
+const char* GetCallSign (int i)
+{
+    if (0 <= i && size_t(i) < gFleet.vInfo.size())
+        return gFleet.vInfo[size_t(i)].callSign;
+    return "";
+}
+
+// Changes the call sign of aircraft at position `i`
+void SetCallSign (int i, const char* callSign)
+{
+    if (0 <= i && size_t(i) < gFleet.vInfo.size())
+        SetStr(gFleet.vInfo[size_t(i)].callSign, callSign);
+}
+
+// Sets heading, pitch, and roll of aircraft at position `i`
+void SetAttitude (int i, float heading, float pitch, float roll)
+{
+    if (0 <= i && size_t(i) < gFleet.vBulk.size()) {
+        LTAPIAircraft::LTAPIBulkData& b = gFleet.vBulk[size_t(i)];
+        b.heading   = heading;
+        b.pitch     = pitch;
+        b.roll      = roll;
+    }
+}
+
+// Puts LiveTraffic's camera on the aircraft at position `i`
+void SetCamera (int i)
+{
+    int modeS_id = 0;
+    for (size_t j = 0; j < gFleet.vBulk.size(); ++j) {
+        gFleet.vBulk[j].bits.camera = int(j) == i;
+        if (int(j) == i)
+            modeS_id = int(gFleet.vBulk[j].keyNum);
+    }
+    XPLMSetDatai(XPLMFindDataRef("sim/multiplayer/camera/modeS_id"), modeS_id);
+    XPLMSetDatai(XPLMFindDataRef("sim/multiplayer/camera/tcas_idx"), modeS_id ? 1 : 0);
+}
+
+// Sets multiplayer index of aircraft at position `i`
+void SetMultiIdx (int i, int multiIdx)
+{
+    if (0 <= i && size_t(i) < gFleet.vBulk.size())
+        gFleet.vBulk[size_t(i)].bits.multiIdx = multiIdx;
+}
+
+// Makes LiveTraffic (un)available
+void SetLTAvail (bool bAvail)
+{
+    gbLTAvail = bAvail;
+}
+
+// Returns served data counters
+const Counters& GetCounters ()
+{
+    return gFleet.cnt;
+}
+
+// Resets served data counters
+void ResetCounters ()
+{
+    gFleet.cnt = Counters();
+}
+
+}
@@ -0,0 +1,95 @@
+/// @file       XPLMStub.h
+/// @brief      Headless stand-in for the XPLM library
+/// @details    Implements the subset of the X-Plane SDK that LTAPI uses,
+///             so that LTAPIConnect can run without X-Plane, e.g. on a
+///             plain Linux box for profiling and benchmarking.\n
+///             Plays the role of LiveTraffic, too: Serves `livetraffic/...`
+///             dataRefs, including `livetraffic/bulk/quick` and
+///             `livetraffic/bulk/expensive`, from an in-memory synthetic fleet.
+/// @see        https://twinfan.github.io/LTAPI/
+/// @author     Birger Hoppe
+/// @copyright  (c) 2019-2025 Birger Hoppe
+/// @copyright  Permission is hereby granted, free of charge, to any person obtaining a
+///             copy of this software and associated documentation files (the "Software"),
+///             to deal in the Software without restriction, including without limitation
+///             the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///             and/or sell copies of the Software, and to permit persons to whom the
+///             Software is furnished to do so, subject to the following conditions:\n
+///             The above copyright notice and this permission notice shall be included in
+///             all copies or substantial portions of the Software.\n
+///             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///             IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///             FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///             AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///             LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///             OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+///             THE SOFTWARE.
+
+#ifndef XPLMStub_h
+#define XPLMStub_h
+
+#include <cstdint>
+#include <cstddef>
+
+/// Controls the synthetic LiveTraffic fleet served by the XPLM stand-in
+namespace XPLMStub {
+
+/// Counters of data served via `livetraffic/bulk/...`
+struct Counters {
+    uint64_t    numGetDatab     = 0;    ///< number of XPLMGetDatab calls with an output buffer
+    uint64_t    bytesQuick      = 0;    ///< bytes copied for `livetraffic/bulk/quick`
+    uint64_t    bytesExpsv      = 0;    ///< bytes copied for `livetraffic/bulk/expensive`
+};
+
+/// @brief (Re)Creates a synthetic fleet of `numAc` aircraft
+/// @param numAc Number of aircraft LiveTraffic shall report
+/// @param seed Seed for the pseudo-random generator, same seed creates same fleet
+void SetFleet (int numAc, uint32_t seed = 1);
+
+/// @brief Moves the fleet forward in time and replaces a share of aircraft
+/// @param dt [s] time to move aircraft along their track
+/// @param churn [0.0..1.0] share of aircraft to remove and replace with new ones
+void Step (float dt, float churn = 0.0f);
+
+/// Number of aircraft currently in the fleet
+int GetNumAc ();
+
+/// Key of aircraft at position `i`, in order as served via the bulk dataRefs
+uint64_t GetKey (int i);
+
+/// Position of aircraft at position `i` as served, `[°]`, `[°]`, `[ft]`
+void GetPos (int i, double& lat, double& lon, double& alt_ft);
+
+/// Call sign of aircraft at position `i` as served
+const char* GetCallSign (int i);
+
+/// Changes the call sign of aircraft at position `i`, as if a flight got a new one
+void SetCallSign (int i, const char* callSign);
+
+/// Sets heading, pitch, and roll `[°]` of aircraft at position `i`, Step() keeps them
+void SetAttitude (int i, float heading, float pitch, float roll);
+
+/// @brief Puts LiveTraffic's camera on the aircraft at position `i`, `-1` switches it off
+/// @details Sets `camera` flag in bulk data and `sim/multiplayer/camera/modeS_id`,
+///          and triggers shared dataRef notifications
+void SetCamera (int i);
+
+/// @brief Sets multiplayer index of aircraft at position `i`
+void SetMultiIdx (int i, int multiIdx);
+
+/// @brief Makes LiveTraffic (un)available
+void SetLTAvail (bool bAvail);
+
+/// @brief Moves the origin of local coordinates, like X-Plane does when the user flies far enough
+/// @note Distances of the fleet are still computed relative to the previous origin until the next Step()
+void SetLocalOrigin (double lat, double lon);
+
+/// Returns served data counters
+const Counters& GetCounters ();
+
+/// Resets served data counters
+void ResetCounters ();
+
+}
+
+#endif /* XPLMStub_h */
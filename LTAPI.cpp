@@ -28,17 +28,64 @@
 ///             THE SOFTWARE.
 
 #include <stdio.h>
+#include <cstdint>
+#include <cmath>
 #include <cstring>
 #include <algorithm>
 #include <cassert>
+#include <atomic>
+#include <type_traits>
 #include "LTAPI.h"
 
 #include "XPLMPlugin.h"
 
-// Windows: I prefer std::min
+// Memory mapping of capture files for replay
+#if IBM
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// SIMD instruction set for column queries:
+// 2 = AVX, 1 = SSE2, 0 = scalar only; define LTAPI_SIMD yourself to override
+#ifndef LTAPI_SIMD
+#if defined(__AVX__)
+#define LTAPI_SIMD 2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LTAPI_SIMD 1
+#else
+#define LTAPI_SIMD 0
+#endif
+#endif
+#if LTAPI_SIMD >= 2
+#include <immintrin.h>
+#elif LTAPI_SIMD == 1
+#include <emmintrin.h>
+#endif
+
+// Windows: I prefer std::min/max
 #ifdef min
 #undef min
 #endif
+#ifdef max
+#undef max
+#endif
+
+// Statistics are only collected if compiled with LTAPI_STATS
+#if LTAPI_STATS
+#define LTAPI_STATS_DO(stmt)    stmt
+
+/// Nanoseconds passed since `t`
+inline uint64_t nsSince (std::chrono::steady_clock::time_point t)
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t).count());
+}
+#else
+#define LTAPI_STATS_DO(stmt)
+#endif
 
 //
 // MARK: Globals
@@ -125,6 +172,109 @@ namespace LTAPI {
         drModeSId.set(modeS_id);
         gbIgnoreBecauseItsMe = false;
     }
+    
+    /// @brief Attitude as unit quaternion
+    /// @param heading [°] heading, rotation about the vertical axis
+    /// @param pitch [°] pitch, positive up
+    /// @param roll [°] roll, positive right
+    /// @param[out] q Quaternion w, x, y, z
+    inline void eulerToQuat (float heading, float pitch, float roll, float q[4])
+    {
+        constexpr float D2R_2 = 3.14159265358979323846f / 360.0f;      // half angles
+        const float cy = std::cos(heading * D2R_2), sy = std::sin(heading * D2R_2);
+        const float cp = std::cos(pitch   * D2R_2), sp = std::sin(pitch   * D2R_2);
+        const float cr = std::cos(roll    * D2R_2), sr = std::sin(roll    * D2R_2);
+        q[0] = cr * cp * cy + sr * sp * sy;
+        q[1] = sr * cp * cy - cr * sp * sy;
+        q[2] = cr * sp * cy + sr * cp * sy;
+        q[3] = cr * cp * sy - sr * sp * cy;
+    }
+    
+    /// @brief Heading, pitch, and roll of a unit quaternion
+    /// @param q Quaternion w, x, y, z
+    /// @param[out] heading [°] heading [0..360)
+    /// @param[out] pitch [°] pitch, positive up
+    /// @param[out] roll [°] roll, positive right
+    inline void quatToEuler (const float q[4], float& heading, float& pitch, float& roll)
+    {
+        constexpr float R2D = 180.0f / 3.14159265358979323846f;
+        roll    = std::atan2(2.0f * (q[0] * q[1] + q[2] * q[3]), 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2])) * R2D;
+        pitch   = std::asin(std::min(std::max(2.0f * (q[0] * q[2] - q[3] * q[1]), -1.0f), 1.0f)) * R2D;
+        heading = std::atan2(2.0f * (q[0] * q[3] + q[1] * q[2]), 1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3])) * R2D;
+        if (heading < 0.0f)
+            heading += 360.0f;
+    }
+    
+    /// @brief Linear interpolation of angles the shorter way round
+    /// @param a0 [°] angle at `f = 0`
+    /// @param a1 [°] angle at `f = 1`
+    /// @param f Fraction [0..1]
+    /// @param lo [°] lower end of the result range, like `0` for [0..360) or `-180` for [-180..180)
+    /// @return [°] interpolated angle in [lo..lo+360)
+    inline float lerpDeg (float a0, float a1, float f, float lo)
+    {
+        float d = a1 - a0;
+        if (d > 180.0f) d -= 360.0f;
+        else if (d < -180.0f) d += 360.0f;
+        float a = a0 + f * d;
+        if (a < lo) a += 360.0f;
+        else if (a >= lo + 360.0f) a -= 360.0f;
+        return a;
+    }
+    
+    /// @brief Spherical linear interpolation between two unit quaternions
+    /// @param q0 Quaternion at `f = 0`
+    /// @param q1 Quaternion at `f = 1`
+    /// @param f Fraction [0..1]
+    /// @param[out] q Interpolated unit quaternion
+    inline void slerp (const float q0[4], const float q1[4], float f, float q[4])
+    {
+        float d = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+        // take the shorter way
+        const float sgn = d < 0.0f ? -1.0f : 1.0f;
+        d *= sgn;
+        float w0 = 1.0f - f, w1 = f * sgn;
+        // Only for larger angles it's worth the trigonometry,
+        // for small ones normalized linear interpolation is just as good
+        if (d < 0.9995f) {
+            const float theta = std::acos(d);
+            const float s = 1.0f / std::sin(theta);
+            w0 = std::sin(w0 * theta) * s;
+            w1 = std::sin(f * theta) * s * sgn;
+        }
+        float len2 = 0.0f;
+        for (int k = 0; k < 4; k++) {
+            q[k] = w0 * q0[k] + w1 * q1[k];
+            len2 += q[k] * q[k];
+        }
+        const float inv = 1.0f / std::sqrt(len2);
+        for (int k = 0; k < 4; k++)
+            q[k] *= inv;
+    }
+    
+    /// @brief Dead reckoning: moves a position along track with ground and vertical speed
+    /// @param dt_s [s] time span, will be limited to [0, LTAPIAircraft::MAX_EXTRAPOLATE_S]
+    /// @param track [°] track over ground
+    /// @param speed_kt [kt] ground speed
+    /// @param vsi_ft [ft/minute] vertical speed, ignored if `bOnGnd`
+    /// @param bOnGnd On ground, i.e. don't change altitude?
+    /// @param[in,out] lat [°] latitude
+    /// @param[in,out] lon [°] longitude
+    /// @param[in,out] alt_ft [ft] altitude
+    inline void deadReckon (double dt_s, float track, float speed_kt, float vsi_ft, bool bOnGnd,
+                            double& lat, double& lon, double& alt_ft)
+    {
+        constexpr double D2R = 3.14159265358979323846 / 180.0;
+        dt_s = std::min(std::max(dt_s, 0.0), double(LTAPIAircraft::MAX_EXTRAPOLATE_S));
+        const double dist_nm = double(speed_kt) * dt_s / 3600.0;
+        const double trk = double(track) * D2R;
+        // equirectangular approximation, good enough for the few nm covered,
+        // avoiding the division by zero at the poles
+        lon += dist_nm / 60.0 * std::sin(trk) / std::max(std::cos(lat * D2R), 1e-6);
+        lat += dist_nm / 60.0 * std::cos(trk);
+        if (!bOnGnd)
+            alt_ft += double(vsi_ft) * dt_s / 60.0;
+    }
 
 }
 
@@ -145,53 +295,87 @@ LTAPIAircraft::~LTAPIAircraft()
 /// 2. a/c type (model ICAO, model human readble)
 /// 3. origin/destination
 /// @return Description of aircraft useful as label
+/// The description is only built upon first request and then kept
+/// until updateAircraft() changes any of the texts it is formed from
 std::string LTAPIAircraft::getDescription() const
 {
-    std::string ret;
+    if (!bDescr) {
+        char buf[128];
+        const size_t len = getDescription(buf, sizeof(buf));
+        descr.assign(buf, std::min(len, sizeof(buf)-1));
+        bDescr = true;
+    }
+    return descr;
+}
+
+size_t LTAPIAircraft::getDescription(char* buf, size_t bufSize) const
+{
+    // Appends to `buf` as far as it fits, but counts the full length
+    size_t len = 0;
+    auto add = [&](std::string_view s)
+    {
+        if (len + 1 < bufSize)
+            memcpy(buf + len, s.data(), std::min(s.size(), bufSize - 1 - len));
+        len += s.size();
+    };
+    
+    const std::string_view flightNumber = getFlightNumberView();
+    const std::string_view callSign     = getCallSignView();
+    const std::string_view modelIcao    = getModelIcaoView();
+    const std::string_view model        = getModelView();
+    const std::string_view origin       = getOriginView();
+    const std::string_view destination  = getDestinationView();
     
     // 1. identifier
-    if (info.flightNumber[0])
-        ret = info.flightNumber;
-    else if (info.callSign[0])
-        ret = info.callSign;
+    if (!flightNumber.empty())
+        add(flightNumber);
+    else if (!callSign.empty())
+        add(callSign);
     else
-        ret = key;
+        add(getKey());                  // short enough for small-string optimization
     
     // 2. a/c type
-    if (info.modelIcao[0]) {
-        ret += " (";
-        ret += info.modelIcao;
-        ret += ')';
-    }
-    else if (info.model[0]) {
-        ret += " (";
-        ret += info.model;
-        ret += ')';
+    const std::string_view type = !modelIcao.empty() ? modelIcao : model;
+    if (!type.empty()) {
+        add(" (");
+        add(type);
+        add(")");
     }
     
     // 3. origin/destination
-    if (info.origin[0] || info.destination[0]) {
-        ret += " ";
-        ret += info.origin[0] ? info.origin : "?";
-        ret += "-";
-        ret += info.destination[0] ? info.destination : "?";
+    if (!origin.empty() || !destination.empty()) {
+        add(" ");
+        add(origin.empty() ? std::string_view("?") : origin);
+        add("-");
+        add(destination.empty() ? std::string_view("?") : destination);
     }
     
-    return ret;
+    if (bufSize > 0)
+        buf[std::min(len, bufSize - 1)] = 0;
+    return len;
+}
+
+/// The hex string is only built upon first request and then kept
+std::string LTAPIAircraft::getKey() const
+{
+    if (key.empty() && bHasKey)
+        key = LTAPI::hexStr(keyNum);
+    return key;
 }
 
 // Main function: Updates an aircraft from LiveTraffic's dataRefs
 
 /// Copies the provided `bulk` data and sets `bUpdated` to `true`
 /// if the provided data matches this aircraft.
-/// @note This function can _set_ this object's `key` for the first and only time.
+/// @note This function can _set_ this object's `keyNum` for the first and only time.
 bool LTAPIAircraft::updateAircraft(const LTAPIBulkData& __bulk, size_t __inSize)
 {
     // first time init of this LTAPIAircraft object?
-    if (key.empty()) {
+    if (!bHasKey) {
         // yes, so we accept the offered aircraft as ours now:
-        keyNum = (unsigned)__bulk.keyNum;
-        key = LTAPI::hexStr(__bulk.keyNum);
+        keyNum = __bulk.keyNum;
+        bHasKey = true;
+        bDescr = false;                 // description may fall back to the key
     } else {
         // our key isn't empty, so we continue only if the aircraft offered
         // is the same!
@@ -217,22 +401,10 @@ bool LTAPIAircraft::updateAircraft(const LTAPIBulkData& __bulk, size_t __inSize)
     return true;
 }
 
-/// Copies the provided `info` data and sets `bUpdated` to `true`
-/// if the provided data matches this aircraft.
-/// @note This function will never overwrite `key`!
-///       A new LTAPIAircraft object will always receive a call to
-///       the above version (with `LTAPIBulkData`) first before receiving
-///       a call to this version (with `LTAPIBulkInfoTexts`).
-bool LTAPIAircraft::updateAircraft(const LTAPIBulkInfoTexts& __info, size_t __inSize)
+/// Makes sure all texts are zero-terminated, and clears what
+/// an older version of LiveTraffic, which sent `inSize` bytes only, didn't send.
+static void NormalizeTexts (LTAPIAircraft::LTAPIBulkInfoTexts& info, size_t inSize)
 {
-    // We continue only if the aircraft offered
-    // is the same as we represent!
-    if (__info.keyNum != keyNum)
-        return false;
-    
-    // just copy the data
-    info = __info;
-
     // We don't trust nobody, so we make sure that the C strings are zero-terminated
     ZERO_TERM(info.registration);
     ZERO_TERM(info.modelIcao);
@@ -253,19 +425,81 @@ bool LTAPIAircraft::updateAircraft(const LTAPIBulkInfoTexts& __info, size_t __in
     
     // version compatibility
     // If LiveTraffic sent v120 number of bytes then we didn't receive cslModel
-    if (__inSize < LTAPIBulkInfoTexts_v122) {
+    if (inSize < LTAPIBulkInfoTexts_v122) {
         memset(info.cslModel, 0, sizeof(info.cslModel));
     }
     // If LiveTraffic sent v122 number of bytes then we receive only 24 chars of cslModel
-    else if (__inSize < LTAPIBulkInfoTexts_v240) {
+    else if (inSize < LTAPIBulkInfoTexts_v240) {
         memset(info.cslModel+24, 0, sizeof(info.cslModel)-24);
     }
+}
 
-    // has been updated
-    bUpdated = true;
+/// Unchanged texts, the usual case, are recognized by one comparison.
+void LTAPIAircraft::CheckTexts (const LTAPIBulkInfoTexts& __info, size_t __inSize)
+{
+    // Nothing changed?
+    // (Compares the bytes LiveTraffic sent with what we stored. Bytes
+    //  LiveTraffic didn't send are cleared in what we stored anyway.)
+    bTextsChanged = false;
+    if (!memcmp(&info, &__info, std::min(__inSize, sizeof(info))))
+        return;
+    
+    // Texts not zero-terminated by LiveTraffic differ from what we stored
+    // although they did not change, so compare once more after normalizing
+    LTAPIBulkInfoTexts newInfo = __info;
+    NormalizeTexts(newInfo, __inSize);
+    if (!memcmp(&info, &newInfo, sizeof(info)))
+        return;
+    
+    // Invalidate the cached description if any text it is formed from changes
+    if (memcmp(info.flightNumber, newInfo.flightNumber, sizeof(info.flightNumber)) ||
+        memcmp(info.callSign,     newInfo.callSign,     sizeof(info.callSign))     ||
+        memcmp(info.modelIcao,    newInfo.modelIcao,    sizeof(info.modelIcao))    ||
+        memcmp(info.model,        newInfo.model,        sizeof(info.model))        ||
+        memcmp(info.origin,       newInfo.origin,       sizeof(info.origin))       ||
+        memcmp(info.destination,  newInfo.destination,  sizeof(info.destination)))
+        bDescr = false;
+    
+    // texts have changed
+    bTextsChanged = true;
+}
+
+/// Copies the provided `info` data if the provided data matches this aircraft.
+/// Doesn't set `bUpdated`, which only numeric data does, see isUpdated().
+/// Skips the copy if CheckTexts() found the texts unchanged.
+/// @note This function will never overwrite `key`!
+///       A new LTAPIAircraft object will always receive a call to
+///       the above version (with `LTAPIBulkData`) first before receiving
+///       a call to this version (with `LTAPIBulkInfoTexts`).
+bool LTAPIAircraft::updateAircraft(const LTAPIBulkInfoTexts& __info, size_t __inSize)
+{
+    // We continue only if the aircraft offered
+    // is the same as we represent!
+    if (__info.keyNum != keyNum)
+        return false;
+    
+    // Nothing changed? Then there's nothing else to do.
+    if (!bTextsChanged)
+        return true;
+    
+    // just copy the data, zero-terminated and cleaned up for older LiveTraffic versions
+    info = __info;
+    NormalizeTexts(info, __inSize);
     return true;
 }
 
+// Dead reckoning from the last fetched numeric data
+void LTAPIAircraft::extrapolate (std::chrono::time_point<std::chrono::steady_clock> ts,
+                                 double& lat, double& lon, double& alt_ft) const
+{
+    lat = bulk.lat;
+    lon = bulk.lon;
+    alt_ft = bulk.alt_ft;
+    LTAPI::deadReckon(std::chrono::duration<double>(ts - tsBulk).count(),
+                      bulk.track, bulk.speed_kt, bulk.vsi_ft, bulk.bits.onGnd,
+                      lat, lon, alt_ft);
+}
+
 // @brief Declare the aircraft the one under the camera (e.g. if your plugin is a camera plugin and now views this aircraft)
 void LTAPIAircraft::setCameraAc ()
 {
@@ -300,227 +534,1983 @@ std::string LTAPIAircraft::getPhaseStr () const
 }
 
 //
-// MARK: LTAPIConnect
+// MARK: LTAPIAcPool
 //
 
-LTAPIConnect::LTAPIConnect(fCreateAcObject* _pfCreateAcObject, int numBulkAc) :
-// clamp numBulkAc between 1 and 100
-iBulkAc(numBulkAc < 1 ? 1 : numBulkAc > 100 ? 100 : numBulkAc),
-// reserve memory for bulk data transfer from LiveTraffic
-vBulkNum (new LTAPIAircraft::LTAPIBulkData[iBulkAc]),
-vInfoTexts(new LTAPIAircraft::LTAPIBulkInfoTexts[iBulkAc]),
-pfCreateAcObject(_pfCreateAcObject)
+// Returns a block of at least `size` bytes
+void* LTAPIAcPool::alloc (size_t size)
 {
-    // Create the shared dataRefs to access camera aircraft event notifications
-    XPLMShareData(SDR_CAMERA_MODES_ID, xplmType_Int, nullptr, nullptr);
-    XPLMShareData(SDR_CAMERA_TCAS_IDX, xplmType_Int, (XPLMDataChanged_f)(&LTAPIConnect::CameraSharedDataCB), this);
+    if (size > MAX_BLOCK)
+        return ::operator new(size);
+    size = BlockSize(size);
+    
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<SizeClass>::iterator iter =
+        std::find_if(vClasses.begin(), vClasses.end(),
+                     [size](const SizeClass& sc) { return sc.size == size; });
+    if (iter == vClasses.end()) {
+        vClasses.emplace_back();
+        iter = std::prev(vClasses.end());
+        iter->size = size;
+    }
+    SizeClass& sc = *iter;
+    
+    // Free list empty? Then allocate a new slab and link all its blocks into the free list
+    if (!sc.pFree) {
+        vSlabs.emplace_back(new char[sc.numNextSlab * size]);
+        bytesSlabs += sc.numNextSlab * size;
+        char* pSlab = vSlabs.back().get();
+        for (size_t i = sc.numNextSlab; i > 0; i--) {
+            void* pBlock = pSlab + (i-1) * size;
+            *static_cast<void**>(pBlock) = sc.pFree;
+            sc.pFree = pBlock;
+        }
+        // next slab will be twice as large, up to a limit
+        sc.numNextSlab = std::min<size_t>(sc.numNextSlab * 2, 1024);
+    }
+    
+    // take the first free block
+    void* p = sc.pFree;
+    sc.pFree = *static_cast<void**>(p);
+    numInUse++;
+    return p;
 }
 
-LTAPIConnect::~LTAPIConnect()
+// Returns a block to the pool
+void LTAPIAcPool::free (void* p, size_t size)
 {
-    XPLMUnshareData(SDR_CAMERA_MODES_ID, xplmType_Int, nullptr, nullptr);
-    XPLMUnshareData(SDR_CAMERA_TCAS_IDX, xplmType_Int, (XPLMDataChanged_f)(&LTAPIConnect::CameraSharedDataCB), this);
+    if (size > MAX_BLOCK) {
+        ::operator delete(p);
+        return;
+    }
+    size = BlockSize(size);
+    
+    std::lock_guard<std::mutex> lock(mtx);
+    for (SizeClass& sc: vClasses)
+        if (sc.size == size) {
+            *static_cast<void**>(p) = sc.pFree;
+            sc.pFree = p;
+            numInUse--;
+            return;
+        }
+    assert(false);                      // block not from this pool
 }
 
-// LiveTraffic available? (checks via XPLMFindPluginBySignature)
-bool LTAPIConnect::isLTAvail ()
+//
+// MARK: LTAPIAcColumns
+//
+
+// Removes all rows, keeps capacity
+void LTAPIAcColumns::clear ()
 {
-    return XPLMFindPluginBySignature(LT_PLUGIN_SIGNATURE) != XPLM_NO_PLUGIN_ID;
+    for (LTAPIAircraft* pAc: ac)
+        pAc->iCol = -1;
+    key.clear();
+    lat.clear();
+    lon.clear();
+    alt_ft.clear();
+    heading.clear();
+    track.clear();
+    speed_kt.clear();
+    vsi_ft.clear();
+    dist_nm.clear();
+    phase.clear();
+    flags.clear();
+    tsBulk_ns.clear();
+    hist.clear();
+    x.clear();
+    y.clear();
+    z.clear();
+    localGen.clear();
+    ac.clear();
 }
 
-// LiveTraffic's version number
-int LTAPIConnect::getLTVerNr()
+// Appends a row for the given aircraft
+void LTAPIAcColumns::push_back (LTAPIAircraft* pAc)
 {
-    static LTDataRef DRVerNr("livetraffic/ver/nr");
-    if (!isLTAvail())                   // LiveTraffic unavailable?
-        return 0;
-    if (DRVerNr.isValid())              // Can fetch version number from LT?
-        return DRVerNr.getInt();
-    else
-        return 150;
+    pAc->iCol = int(size());
+    key.push_back(0);
+    lat.push_back(0.0);
+    lon.push_back(0.0);
+    alt_ft.push_back(0.0);
+    heading.push_back(0.0f);
+    track.push_back(0.0f);
+    speed_kt.push_back(0.0f);
+    vsi_ft.push_back(0.0f);
+    dist_nm.push_back(0.0f);
+    phase.push_back(0);
+    flags.push_back(0);
+    tsBulk_ns.push_back(0);
+    if (bHist)
+        hist.emplace_back();
+    x.push_back(0.0);
+    y.push_back(0.0);
+    z.push_back(0.0);
+    localGen.push_back(0);
+    ac.push_back(pAc);
+    set(size_t(pAc->iCol));
 }
 
-/// @brief LiveTraffic's version date
-/// @details Version date became available with v2.01 only. This is why 20191231 is returned in case
-///          LiveTraffic is available, but not the dataRef to fetch the date from.
-/// @return Version date (like 20200430 for 30-APR-2020), or constant 20191231 if unknown, or 0 if LiveTraffic is unavailable
-int LTAPIConnect::getLTVerDate()
+// Updates row `i` from its aircraft object
+void LTAPIAcColumns::set (size_t i)
 {
-    static LTDataRef DRVerDate("livetraffic/ver/date");
-    if (!isLTAvail())                   // LiveTraffic unavailable?
-        return 0;
-    if (DRVerDate.isValid())            // Can fetch version date from LT?
-        return DRVerDate.getInt();
-    else
-        return 20191231;
+    const LTAPIAircraft& a = *ac[i];
+    const LTAPIAircraft::LTAPIBulkData::BulkBitsTy& bits = a.bulk.bits;
+    // local coordinates need recomputing if the position changes
+    if (std::memcmp(&lat[i],    &a.bulk.lat,    sizeof(double)) ||
+        std::memcmp(&lon[i],    &a.bulk.lon,    sizeof(double)) ||
+        std::memcmp(&alt_ft[i], &a.bulk.alt_ft, sizeof(double)))
+        localGen[i] = 0;
+    key[i]      = a.keyNum;
+    lat[i]      = a.bulk.lat;
+    lon[i]      = a.bulk.lon;
+    alt_ft[i]   = a.bulk.alt_ft;
+    heading[i]  = a.bulk.heading;
+    track[i]    = a.bulk.track;
+    speed_kt[i] = a.bulk.speed_kt;
+    vsi_ft[i]   = a.bulk.vsi_ft;
+    dist_nm[i]  = a.bulk.dist_nm;
+    phase[i]    = uint8_t(bits.phase);
+    flags[i]    = uint8_t((bits.onGnd  ? FL_ON_GND  : 0) |
+                          (bits.hidden ? FL_HIDDEN  : 0) |
+                          (bits.camera ? FL_CAMERA  : 0) |
+                          (bits.land   ? FL_LANDING : 0) |
+                          (bits.taxi   ? FL_TAXI    : 0) |
+                          (bits.bcn    ? FL_BCN     : 0) |
+                          (bits.strb   ? FL_STRB    : 0) |
+                          (bits.nav    ? FL_NAV     : 0));
+    tsBulk_ns[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(a.tsBulk.time_since_epoch()).count();
+    
+    // add a sample to the history, unless it is just the same fetch again
+    if (bHist) {
+        History& h = hist[i];
+        if (h.num == 0 || h.s[(h.next + HIST_SIZE - 1) % HIST_SIZE].ts_ns != tsBulk_ns[i]) {
+            Sample& smp = h.s[h.next];
+            smp.ts_ns   = tsBulk_ns[i];
+            smp.lat     = a.bulk.lat;
+            smp.lon     = a.bulk.lon;
+            smp.alt_ft  = a.bulk.alt_ft;
+            smp.heading = a.bulk.heading;
+            smp.pitch   = a.bulk.pitch;
+            smp.roll    = a.bulk.roll;
+            LTAPI::eulerToQuat(a.bulk.heading, a.bulk.pitch, a.bulk.roll, smp.q);
+            h.next = uint8_t((h.next + 1) % HIST_SIZE);
+            if (h.num < HIST_SIZE)
+                h.num++;
+        }
+    }
 }
 
-
-// Does LiveTraffic display aircrafts? (Is it activated?)
-bool LTAPIConnect::doesLTDisplayAc ()
+// Removes row `i` by moving the last row into its place
+LTAPIAircraft* LTAPIAcColumns::swapRemove (size_t i)
 {
-    static LTDataRef DRAcDisplayed("livetraffic/cfg/aircrafts_displayed");
-    // this is the only function which tries to find the dataRef over and over again
-    if (!DRAcDisplayed.isValid())
-        DRAcDisplayed.FindDataRef();
-    return DRAcDisplayed.getBool();
+    const size_t last = size() - 1;
+    LTAPIAircraft* pMoved = nullptr;
+    if (i != last) {
+        key[i]      = key[last];
+        lat[i]      = lat[last];
+        lon[i]      = lon[last];
+        alt_ft[i]   = alt_ft[last];
+        heading[i]  = heading[last];
+        track[i]    = track[last];
+        speed_kt[i] = speed_kt[last];
+        vsi_ft[i]   = vsi_ft[last];
+        dist_nm[i]  = dist_nm[last];
+        phase[i]    = phase[last];
+        flags[i]    = flags[last];
+        tsBulk_ns[i] = tsBulk_ns[last];
+        if (bHist)
+            hist[i] = hist[last];
+        x[i]        = x[last];
+        y[i]        = y[last];
+        z[i]        = z[last];
+        localGen[i] = localGen[last];
+        ac[i]       = pMoved = ac[last];
+    }
+    key.pop_back();
+    lat.pop_back();
+    lon.pop_back();
+    alt_ft.pop_back();
+    heading.pop_back();
+    track.pop_back();
+    speed_kt.pop_back();
+    vsi_ft.pop_back();
+    dist_nm.pop_back();
+    phase.pop_back();
+    flags.pop_back();
+    tsBulk_ns.pop_back();
+    if (bHist)
+        hist.pop_back();
+    x.pop_back();
+    y.pop_back();
+    z.pop_back();
+    localGen.pop_back();
+    ac.pop_back();
+    return pMoved;
 }
 
-// How many of them right now?
-int LTAPIConnect::getLTNumAc ()
+// Dead reckoning of all rows
+void LTAPIAcColumns::extrapolate (std::chrono::time_point<std::chrono::steady_clock> ts,
+                                  std::vector<double>& outLat, std::vector<double>& outLon,
+                                  std::vector<double>& outAlt_ft) const
 {
-    RETURN_DR("livetraffic/ac/num",Int);
+    const size_t n = size();
+    outLat.resize(n);
+    outLon.resize(n);
+    outAlt_ft.resize(n);
+    const int64_t ts_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(ts.time_since_epoch()).count();
+    for (size_t i = 0; i < n; i++) {
+        outLat[i] = lat[i];
+        outLon[i] = lon[i];
+        outAlt_ft[i] = alt_ft[i];
+        LTAPI::deadReckon(double(ts_ns - tsBulk_ns[i]) / 1e9,
+                          track[i], speed_kt[i], vsi_ft[i], (flags[i] & FL_ON_GND) != 0,
+                          outLat[i], outLon[i], outAlt_ft[i]);
+    }
 }
 
-// Does it (also) control AI planes?
-bool LTAPIConnect::doesLTControlAI ()
+// Interpolates positions and attitudes of all rows between buffered samples
+void LTAPIAcColumns::interpolate (std::chrono::time_point<std::chrono::steady_clock> ts,
+                                  std::vector<Pose>& outPose) const
 {
-    RETURN_DR("livetraffic/cfg/ai_controlled",Bool);
+    const size_t n = hist.size();
+    outPose.resize(n);
+    const int64_t ts_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(ts.time_since_epoch()).count();
+    for (size_t i = 0; i < n; i++) {
+        const History& h = hist[i];
+        Pose& p = outPose[i];
+        if (h.num == 0) {
+            p = Pose{lat[i], lon[i], alt_ft[i], heading[i], 0.0f, 0.0f};
+            continue;
+        }
+        
+        // Find the newest sample not after `ts`, walking backwards from the newest one
+        const Sample* pNewer = nullptr;
+        const Sample* pOlder = &h.s[(h.next + HIST_SIZE - 1) % HIST_SIZE];
+        for (unsigned k = 2; k <= h.num && pOlder->ts_ns > ts_ns; k++) {
+            pNewer = pOlder;
+            pOlder = &h.s[(h.next + HIST_SIZE - k) % HIST_SIZE];
+        }
+        
+        // Outside the buffered time span, or right on a sample: return that sample
+        if (!pNewer || pOlder->ts_ns >= ts_ns) {
+            p = Pose{pOlder->lat, pOlder->lon, pOlder->alt_ft,
+                     pOlder->heading, pOlder->pitch, pOlder->roll};
+            continue;
+        }
+        
+        const double f = double(ts_ns - pOlder->ts_ns) / double(pNewer->ts_ns - pOlder->ts_ns);
+        // shortest way across the antimeridian
+        double dLon = pNewer->lon - pOlder->lon;
+        if (dLon > 180.0) dLon -= 360.0;
+        else if (dLon < -180.0) dLon += 360.0;
+        p.lat    = pOlder->lat + f * (pNewer->lat - pOlder->lat);
+        p.lon    = pOlder->lon + f * dLon;
+        if (p.lon > 180.0) p.lon -= 360.0;
+        else if (p.lon < -180.0) p.lon += 360.0;
+        p.alt_ft = pOlder->alt_ft + f * (pNewer->alt_ft - pOlder->alt_ft);
+        
+        // Small rotation? Then interpolating the angles is as good as slerp, and a lot cheaper
+        const float* q0 = pOlder->q;
+        const float* q1 = pNewer->q;
+        const float d = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+        if (std::fabs(d) > 0.9995f) {
+            p.heading = LTAPI::lerpDeg(pOlder->heading, pNewer->heading, float(f),    0.0f);
+            p.pitch   = LTAPI::lerpDeg(pOlder->pitch,   pNewer->pitch,   float(f), -180.0f);
+            p.roll    = LTAPI::lerpDeg(pOlder->roll,    pNewer->roll,    float(f), -180.0f);
+        }
+        else {
+            float q[4];
+            LTAPI::slerp(q0, q1, float(f), q);
+            LTAPI::quatToEuler(q, p.heading, p.pitch, p.roll);
+        }
+    }
 }
 
-// What's current simulated time in LiveTraffic (usually 'now' minus buffering period)?
-time_t LTAPIConnect::getLTSimTime ()
+// Adds row indexes of all bits set in a SIMD comparison mask.
+// Writes branch-free: every index is written, but the output pointer only advances for matches.
+template <unsigned W>
+static inline uint32_t* AddMatches (unsigned mask, size_t i, uint32_t* pOut)
 {
-    struct tm t;
-    memset(&t, 0, sizeof(t));
-    
-    int i = 0;
-    ASSIGN_DR_NAME(i, Date, "livetraffic/sim/date", Int);
-    t.tm_year = i / 10000;
-    i -= t.tm_year * 10000;
-    t.tm_mon = i / 100 - 1;
-    t.tm_mday = i % 100;
-
-    ASSIGN_DR_NAME(i, Time, "livetraffic/sim/time", Int);
-    t.tm_hour   = i / 10000;
-    t.tm_min    = (i % 10000) / 100;
-    t.tm_sec    = i % 100;
-    
-    return LTAPI::timegm(&t);
+    for (unsigned b = 0; b < W; b++) {
+        *pOut = uint32_t(i + b);
+        pOut += (mask >> b) & 1;
+    }
+    return pOut;
 }
 
-std::chrono::system_clock::time_point LTAPIConnect::getLTSimTimePoint ()
+// Prepares the output vector for branch-free writing of up to `n` indexes
+static inline uint32_t* StartMatches (std::vector<uint32_t>& outIdx, size_t n)
 {
-    return std::chrono::system_clock::from_time_t(getLTSimTime());
+    outIdx.resize(n + 1);           // one extra slot for the write-behind of the last index
+    return outIdx.data();
 }
 
-
-const MapLTAPIAircraft& LTAPIConnect::UpdateAcList (ListLTAPIAircraft* plistRemovedAc)
+// Shrinks the output vector to the number of actually found matches
+static inline size_t EndMatches (std::vector<uint32_t>& outIdx, const uint32_t* pOut)
 {
-    // These are the bulk input/output dataRefs in LiveTraffic,
-    // with which we fetch mass data from LiveTraffic
-    static LTDataRef DRquick("livetraffic/bulk/quick");
-    static LTDataRef DRexpsv("livetraffic/bulk/expensive");
+    outIdx.resize(size_t(pOut - outIdx.data()));
+    return outIdx.size();
+}
 
-    // a few sanity checks...without LT displaying aircrafts
-    // and access to ac/key there is nothing to do.
-    // (Calling doesLTDisplayAc before calling any other dataRef
-    //  makes sure we only try accessing dataRefs when they are available.)
-    const int numAc = isLTAvail() && doesLTDisplayAc() && DRquick.isValid() && DRexpsv.isValid() ? getLTNumAc() : 0;
-    if (numAc <= 0) {
-        // does caller want to know about removed aircrafts?
-        if (plistRemovedAc)
-            for (MapLTAPIAircraft::value_type& p: mapAc)
-                // move all objects over to the caller's list's end
-                plistRemovedAc->emplace_back(std::move(p.second));
-        // clear our map
-        mapAc.clear();
-        return mapAc;
-    }
-    
-    // *** There are numAc aircrafts to be reported ***
+// Rows within `nm` nautical miles of the given position
+size_t LTAPIAcColumns::findWithinRadius (double lat0, double lon0, double nm,
+                                         std::vector<uint32_t>& outIdx) const
+{
+    // Equirectangular approximation: 60nm per degree latitude,
+    // degrees longitude shrink with the cosine of the latitude
+    const double ky = 60.0;
+    const double kx = 60.0 * std::cos(lat0 * 3.14159265358979323846 / 180.0);
+    const double r2 = nm * nm;
+    const size_t n = size();
+    size_t i = 0;
+    uint32_t* pOut = StartMatches(outIdx, n);
     
-    // To figure out which aircraft has gone we keep an update flag
-    // with the aircraft. Let's reset that flag first.
-    for (MapLTAPIAircraft::value_type& p: mapAc)
-        p.second->resetUpdated();
+#if LTAPI_SIMD >= 2
+    const __m256d vLat0 = _mm256_set1_pd(lat0), vLon0 = _mm256_set1_pd(lon0);
+    const __m256d vKx = _mm256_set1_pd(kx), vKy = _mm256_set1_pd(ky), vR2 = _mm256_set1_pd(r2);
+    const __m256d v180 = _mm256_set1_pd(180.0), vM180 = _mm256_set1_pd(-180.0), v360 = _mm256_set1_pd(360.0);
+    for (; i + 4 <= n; i += 4) {
+        __m256d dLon = _mm256_sub_pd(_mm256_loadu_pd(&lon[i]), vLon0);
+        dLon = _mm256_sub_pd(dLon, _mm256_and_pd(_mm256_cmp_pd(dLon, v180, _CMP_GT_OQ), v360));
+        dLon = _mm256_add_pd(dLon, _mm256_and_pd(_mm256_cmp_pd(dLon, vM180, _CMP_LT_OQ), v360));
+        const __m256d dx = _mm256_mul_pd(dLon, vKx);
+        const __m256d dy = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(&lat[i]), vLat0), vKy);
+        const __m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        pOut = AddMatches<4>(unsigned(_mm256_movemask_pd(_mm256_cmp_pd(d2, vR2, _CMP_LE_OQ))), i, pOut);
+    }
+#elif LTAPI_SIMD == 1
+    const __m128d vLat0 = _mm_set1_pd(lat0), vLon0 = _mm_set1_pd(lon0);
+    const __m128d vKx = _mm_set1_pd(kx), vKy = _mm_set1_pd(ky), vR2 = _mm_set1_pd(r2);
+    const __m128d v180 = _mm_set1_pd(180.0), vM180 = _mm_set1_pd(-180.0), v360 = _mm_set1_pd(360.0);
+    for (; i + 2 <= n; i += 2) {
+        __m128d dLon = _mm_sub_pd(_mm_loadu_pd(&lon[i]), vLon0);
+        dLon = _mm_sub_pd(dLon, _mm_and_pd(_mm_cmpgt_pd(dLon, v180), v360));
+        dLon = _mm_add_pd(dLon, _mm_and_pd(_mm_cmplt_pd(dLon, vM180), v360));
+        const __m128d dx = _mm_mul_pd(dLon, vKx);
+        const __m128d dy = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(&lat[i]), vLat0), vKy);
+        const __m128d d2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        pOut = AddMatches<2>(unsigned(_mm_movemask_pd(_mm_cmple_pd(d2, vR2))), i, pOut);
+    }
+#endif
     
-    // *** Read bulk info from LiveTraffic ***
+    // scalar remainder, same calculation as above
+    for (; i < n; i++) {
+        double dLon = lon[i] - lon0;
+        if (dLon > 180.0) dLon -= 360.0;
+        if (dLon < -180.0) dLon += 360.0;
+        const double dx = dLon * kx;
+        const double dy = (lat[i] - lat0) * ky;
+        *pOut = uint32_t(i);
+        pOut += dx*dx + dy*dy <= r2;
+    }
+    return EndMatches(outIdx, pOut);
+}
+
+// Rows inside the given lat/lon box
+size_t LTAPIAcColumns::findInBox (double latMin, double latMax, double lonMin, double lonMax,
+                                  std::vector<uint32_t>& outIdx) const
+{
+    // box crossing the antimeridian: longitude needs to satisfy only one of the limits
+    const bool bWrap = lonMin > lonMax;
+    const size_t n = size();
+    size_t i = 0;
+    uint32_t* pOut = StartMatches(outIdx, n);
     
-    // Always do the rather fast call for numeric data
-    int sizeLTStruct = 0;                     // not yet used, will become important once different versions exist
-    if (DoBulkFetch<LTAPIAircraft::LTAPIBulkData>(numAc, DRquick, sizeLTStruct,
-                                                  vBulkNum) ||
-        // do the expensive call for textual data if the above one added new objects, OR
-        // if 3 seconds have passed since the last call
-        std::chrono::steady_clock::now() - lastExpsvFetch > sPeriodExpsv)
-    {
-        // expensive call for textual data
-        sizeLTStruct = 0;
-        DoBulkFetch<LTAPIAircraft::LTAPIBulkInfoTexts>(numAc, DRexpsv, sizeLTStruct,
-                                                       vInfoTexts);
-        lastExpsvFetch = std::chrono::steady_clock::now();
+#if LTAPI_SIMD >= 2
+    const __m256d vLatMin = _mm256_set1_pd(latMin), vLatMax = _mm256_set1_pd(latMax);
+    const __m256d vLonMin = _mm256_set1_pd(lonMin), vLonMax = _mm256_set1_pd(lonMax);
+    for (; i + 4 <= n; i += 4) {
+        const __m256d vLat = _mm256_loadu_pd(&lat[i]);
+        const __m256d vLon = _mm256_loadu_pd(&lon[i]);
+        const __m256d mLat = _mm256_and_pd(_mm256_cmp_pd(vLat, vLatMin, _CMP_GE_OQ),
+                                           _mm256_cmp_pd(vLat, vLatMax, _CMP_LE_OQ));
+        const __m256d mLonMin = _mm256_cmp_pd(vLon, vLonMin, _CMP_GE_OQ);
+        const __m256d mLonMax = _mm256_cmp_pd(vLon, vLonMax, _CMP_LE_OQ);
+        const __m256d mLon = bWrap ? _mm256_or_pd(mLonMin, mLonMax) : _mm256_and_pd(mLonMin, mLonMax);
+        pOut = AddMatches<4>(unsigned(_mm256_movemask_pd(_mm256_and_pd(mLat, mLon))), i, pOut);
     }
-        
-    // ***  Now handle aircrafts in our map, which did _not_ get updated ***
-    for (MapLTAPIAircraft::iterator iter = mapAc.begin();
-         iter != mapAc.end();
-         /* no loop increment*/)
-    {
-        // not updated?
-        if (!iter->second->isUpdated()) {
-            // Does caller want to take over them?
-            if (plistRemovedAc)
-                // here you go...your object now
-                plistRemovedAc->emplace_back(std::move(iter->second));
-            // in any case: remove from our map and increment to next element
-            iter = mapAc.erase(iter);
-        }
-        else
-            // go to next element (without removing this one)
-            iter++;
+#elif LTAPI_SIMD == 1
+    const __m128d vLatMin = _mm_set1_pd(latMin), vLatMax = _mm_set1_pd(latMax);
+    const __m128d vLonMin = _mm_set1_pd(lonMin), vLonMax = _mm_set1_pd(lonMax);
+    for (; i + 2 <= n; i += 2) {
+        const __m128d vLat = _mm_loadu_pd(&lat[i]);
+        const __m128d vLon = _mm_loadu_pd(&lon[i]);
+        const __m128d mLat = _mm_and_pd(_mm_cmpge_pd(vLat, vLatMin), _mm_cmple_pd(vLat, vLatMax));
+        const __m128d mLonMin = _mm_cmpge_pd(vLon, vLonMin);
+        const __m128d mLonMax = _mm_cmple_pd(vLon, vLonMax);
+        const __m128d mLon = bWrap ? _mm_or_pd(mLonMin, mLonMax) : _mm_and_pd(mLonMin, mLonMax);
+        pOut = AddMatches<2>(unsigned(_mm_movemask_pd(_mm_and_pd(mLat, mLon))), i, pOut);
     }
+#endif
     
-    // We're done, return the result
-    return mapAc;
+    // scalar remainder
+    for (; i < n; i++) {
+        const bool bLon = bWrap ?
+            (lon[i] >= lonMin || lon[i] <= lonMax) :
+            (lon[i] >= lonMin && lon[i] <= lonMax);
+        *pOut = uint32_t(i);
+        pOut += bLon && lat[i] >= latMin && lat[i] <= latMax;
+    }
+    return EndMatches(outIdx, pOut);
 }
 
-// Finds an aircraft for a given multiplayer slot
-SPtrLTAPIAircraft LTAPIConnect::getAcByMultIdx (int multiIdx) const
+// Rows with an altitude in [altMin_ft, altMax_ft]
+size_t LTAPIAcColumns::findInAltBand (double altMin_ft, double altMax_ft,
+                                      std::vector<uint32_t>& outIdx) const
 {
-    // sanity check: Don't search for 0...there are too many of them
-    if (multiIdx < 1)
-        return SPtrLTAPIAircraft();
+    const size_t n = size();
+    size_t i = 0;
+    uint32_t* pOut = StartMatches(outIdx, n);
     
-    // search the map for a matching aircraft
-    MapLTAPIAircraft::const_iterator iter =
-    std::find_if(mapAc.cbegin(), mapAc.cend(),
-                 [multiIdx](const MapLTAPIAircraft::value_type& pair)
-                 { return pair.second->getMultiIdx() == multiIdx; });
+#if LTAPI_SIMD >= 2
+    const __m256d vMin = _mm256_set1_pd(altMin_ft), vMax = _mm256_set1_pd(altMax_ft);
+    for (; i + 4 <= n; i += 4) {
+        const __m256d vAlt = _mm256_loadu_pd(&alt_ft[i]);
+        const __m256d m = _mm256_and_pd(_mm256_cmp_pd(vAlt, vMin, _CMP_GE_OQ),
+                                        _mm256_cmp_pd(vAlt, vMax, _CMP_LE_OQ));
+        pOut = AddMatches<4>(unsigned(_mm256_movemask_pd(m)), i, pOut);
+    }
+#elif LTAPI_SIMD == 1
+    const __m128d vMin = _mm_set1_pd(altMin_ft), vMax = _mm_set1_pd(altMax_ft);
+    for (; i + 2 <= n; i += 2) {
+        const __m128d vAlt = _mm_loadu_pd(&alt_ft[i]);
+        const __m128d m = _mm_and_pd(_mm_cmpge_pd(vAlt, vMin), _mm_cmple_pd(vAlt, vMax));
+        pOut = AddMatches<2>(unsigned(_mm_movemask_pd(m)), i, pOut);
+    }
+#endif
     
-    // return a copy of the pointer if found
-    return iter == mapAc.cend() ? SPtrLTAPIAircraft() : iter->second;
+    // scalar remainder
+    for (; i < n; i++) {
+        *pOut = uint32_t(i);
+        pOut += alt_ft[i] >= altMin_ft && alt_ft[i] <= altMax_ft;
+    }
+    return EndMatches(outIdx, pOut);
 }
 
+//
+// MARK: LTAPILocalFrame
+//
 
-// Returns the aircraft being viewed in LiveTraffic's camera view, if any
-SPtrLTAPIAircraft LTAPIConnect::getAcInCameraView() const
+/// [m] Earth radius, same as X-Plane's
+constexpr double LTAPI_EARTH_R_M = 6378145.0;
+
+// Earth-centered, Earth-fixed coordinates on a spherical earth
+void LTAPILocalFrame::ToECEF (double lat, double lon, double alt_m, double ecef[3])
 {
-    // search the map for a matching aircraft
-    MapLTAPIAircraft::const_iterator iter =
-        std::find_if(mapAc.cbegin(), mapAc.cend(),
-            [](const MapLTAPIAircraft::value_type& pair)
-            { return pair.second->isOnCamera(); });
+    constexpr double D2R = 3.14159265358979323846 / 180.0;
+    const double r = LTAPI_EARTH_R_M + alt_m;
+    const double cosLat = std::cos(lat * D2R);
+    ecef[0] = r * cosLat * std::cos(lon * D2R);
+    ecef[1] = r * cosLat * std::sin(lon * D2R);
+    ecef[2] = r * std::sin(lat * D2R);
+}
 
-    // return a copy of the pointer if found
-    return iter == mapAc.cend() ? SPtrLTAPIAircraft() : iter->second;
+// Determines the transformation for X-Plane's current local origin
+void LTAPILocalFrame::calibrate ()
+{
+    // Reference is the local origin
+    XPLMLocalToWorld(0.0, 0.0, 0.0, &lat0, &lon0, &alt0_m);
+    ToECEF(lat0, lon0, alt0_m, ecef0);
+    XPLMWorldToLocal(lat0, lon0, alt0_m, &local0[0], &local0[1], &local0[2]);
+    
+    // Three more points, 10 km east, north, and up of the reference point in local coordinates,
+    // as differences to the reference point, in ECEF (d) and local (l) coordinates.
+    // (Metric offsets, unlike offsets in degrees, span all three axes also close to the poles.)
+    constexpr double OFS_M = 10000.0;
+    const double ofs[3][3] = {
+        { OFS_M, 0.0,   0.0    },                       // x: east
+        { 0.0,   0.0,   -OFS_M },                       // -z: north
+        { 0.0,   OFS_M, 0.0    },                       // y: up
+    };
+    double d[3][3], l[3][3];                            // column k = point k
+    for (int k = 0; k < 3; k++) {
+        double lat, lon, alt_m, e[3], loc[3];
+        XPLMLocalToWorld(local0[0] + ofs[k][0], local0[1] + ofs[k][1], local0[2] + ofs[k][2],
+                         &lat, &lon, &alt_m);
+        // local coordinates of exactly that world position, not subject to rounding in lat/lon
+        ToECEF(lat, lon, alt_m, e);
+        XPLMWorldToLocal(lat, lon, alt_m, &loc[0], &loc[1], &loc[2]);
+        for (int r = 0; r < 3; r++) {
+            d[r][k] = e[r] - ecef0[r];
+            l[r][k] = loc[r] - local0[r];
+        }
+    }
+    
+    // m = l * d^-1, with d^-1 via adjugate and determinant
+    const double inv[3][3] = {
+        { d[1][1]*d[2][2] - d[1][2]*d[2][1], d[0][2]*d[2][1] - d[0][1]*d[2][2], d[0][1]*d[1][2] - d[0][2]*d[1][1] },
+        { d[1][2]*d[2][0] - d[1][0]*d[2][2], d[0][0]*d[2][2] - d[0][2]*d[2][0], d[0][2]*d[1][0] - d[0][0]*d[1][2] },
+        { d[1][0]*d[2][1] - d[1][1]*d[2][0], d[0][1]*d[2][0] - d[0][0]*d[2][1], d[0][0]*d[1][1] - d[0][1]*d[1][0] },
+    };
+    const double det = d[0][0]*inv[0][0] + d[0][1]*inv[1][0] + d[0][2]*inv[2][0];
+    for (int r = 0; r < 3; r++)
+        for (int c = 0; c < 3; c++)
+            m[r][c] = (l[r][0]*inv[0][c] + l[r][1]*inv[1][c] + l[r][2]*inv[2][c]) / det;
+    
+    // new generation, skipping 0, which stands for "not calibrated"
+    if (++gen == 0)
+        gen = 1;
 }
 
+// Has X-Plane moved its local origin?
+bool LTAPILocalFrame::isShifted () const
+{
+    double loc[3];
+    XPLMWorldToLocal(lat0, lon0, alt0_m, &loc[0], &loc[1], &loc[2]);
+    return std::fabs(loc[0] - local0[0]) > 0.001 ||
+           std::fabs(loc[1] - local0[1]) > 0.001 ||
+           std::fabs(loc[2] - local0[2]) > 0.001;
+}
 
-// LTAPIConnect::Clear camera information, ie. delcare that no aircraft is currently being viewed
-void clearCameraInfo ()
+// Converts a position to local coordinates
+void LTAPILocalFrame::toLocal (double lat, double lon, double alt_m,
+                               double& x, double& y, double& z) const
 {
-    LTAPI::setCameraAcDataRefs(0, 0);
+    double e[3];
+    ToECEF(lat, lon, alt_m, e);
+    e[0] -= ecef0[0];
+    e[1] -= ecef0[1];
+    e[2] -= ecef0[2];
+    x = local0[0] + m[0][0]*e[0] + m[0][1]*e[1] + m[0][2]*e[2];
+    y = local0[1] + m[1][0]*e[0] + m[1][1]*e[1] + m[1][2]*e[2];
+    z = local0[2] + m[2][0]*e[0] + m[2][1]*e[1] + m[2][2]*e[2];
 }
 
+//
+// MARK: LTAPIGridIndex
+//
 
-// fetch bulk data and create/update aircraft objects
+// Defines cell size and removes all aircraft
+void LTAPIGridIndex::init (double _cellDeg)
+{
+    clear();
+    mapCells.clear();
+    cellDeg = std::max(_cellDeg, 0.01);
+    nx = uint64_t(std::ceil(360.0 / cellDeg));
+    ny = uint64_t(std::ceil(180.0 / cellDeg));
+}
+
+// Removes all aircraft
+void LTAPIGridIndex::clear ()
+{
+    for (auto& cell: mapCells) {
+        for (LTAPIAircraft* pAc: cell.second)
+            pAc->gridPos = -1;
+        cell.second.clear();
+    }
+    numAc = 0;
+}
+
+// Cell key of a position
+uint64_t LTAPIGridIndex::cellOf (double lat, double lon) const
+{
+    const double fy = std::floor((lat + 90.0) / cellDeg);
+    const double fx = std::floor((lon + 180.0) / cellDeg);
+    const uint64_t iy = fy <= 0.0 ? 0 : std::min(uint64_t(fy), ny - 1);
+    const uint64_t ix = fx <= 0.0 ? 0 : std::min(uint64_t(fx), nx - 1);
+    return iy * nx + ix;
+}
+
+// Adds an aircraft to the index
+void LTAPIGridIndex::insert (LTAPIAircraft* pAc)
+{
+    pAc->gridCell = cellOf(pAc->bulk.lat, pAc->bulk.lon);
+    std::vector<LTAPIAircraft*>& vCell = mapCells[pAc->gridCell];
+    pAc->gridPos = int(vCell.size());
+    vCell.push_back(pAc);
+    numAc++;
+}
+
+// Moves an aircraft to another cell if its position requires so
+void LTAPIGridIndex::update (LTAPIAircraft* pAc)
+{
+    if (pAc->gridPos < 0)
+        insert(pAc);
+    else if (cellOf(pAc->bulk.lat, pAc->bulk.lon) != pAc->gridCell) {
+        remove(pAc);
+        insert(pAc);
+    }
+}
+
+// Removes an aircraft from the index
+void LTAPIGridIndex::remove (LTAPIAircraft* pAc)
+{
+    if (pAc->gridPos < 0) return;
+    std::vector<LTAPIAircraft*>& vCell = mapCells[pAc->gridCell];
+    // move the cell's last aircraft into the place of the removed one
+    LTAPIAircraft* pLast = vCell.back();
+    vCell[size_t(pAc->gridPos)] = pLast;
+    pLast->gridPos = pAc->gridPos;
+    vCell.pop_back();
+    pAc->gridPos = -1;
+    numAc--;
+}
+
+// Adds all aircraft of the given cell within `r2` squared nm to `outHits`
+void LTAPIGridIndex::collect (uint64_t iy, uint64_t ix, double lat0, double lon0, double kx,
+                              double r2, VecHit& outHits) const
+{
+    const auto iter = mapCells.find(iy * nx + ix);
+    if (iter == mapCells.end())
+        return;
+    for (LTAPIAircraft* pAc: iter->second) {
+        double dLon = pAc->bulk.lon - lon0;
+        if (dLon > 180.0) dLon -= 360.0;
+        if (dLon < -180.0) dLon += 360.0;
+        const double dx = dLon * kx;
+        const double dy = (pAc->bulk.lat - lat0) * 60.0;
+        const double d2 = dx*dx + dy*dy;
+        if (d2 <= r2)
+            outHits.push_back(Hit{std::sqrt(d2), pAc});
+    }
+}
+
+// All aircraft within `nm` nautical miles of the given position
+size_t LTAPIGridIndex::withinRadius (double lat0, double lon0, double nm, VecHit& outHits) const
+{
+    outHits.clear();
+    const double kx = 60.0 * std::cos(lat0 * 3.14159265358979323846 / 180.0);
+    const double r2 = nm * nm;
+    
+    // range of cell rows
+    const double latMin = lat0 - nm / 60.0, latMax = lat0 + nm / 60.0;
+    const uint64_t iyMin = cellOf(latMin, lon0) / nx;
+    const uint64_t iyMax = cellOf(latMax, lon0) / nx;
+    // range of cell columns, all of them if the circle covers a pole
+    const double dLonDeg = kx > 0.001 ? nm / kx : 360.0;
+    const uint64_t numX = dLonDeg >= 180.0 ? nx :
+        std::min(nx, uint64_t(std::ceil(2.0 * dLonDeg / cellDeg)) + 2);
+    const uint64_t ixStart = dLonDeg >= 180.0 ? 0 :
+        (cellOf(lat0, lon0) % nx + nx - (numX - 1) / 2) % nx;
+    
+    for (uint64_t iy = iyMin; iy <= iyMax; iy++)
+        for (uint64_t x = 0; x < numX; x++)
+            collect(iy, (ixStart + x) % nx, lat0, lon0, kx, r2, outHits);
+    return outHits.size();
+}
+
+// The `n` aircraft nearest to the given position
+size_t LTAPIGridIndex::nearestN (double lat0, double lon0, size_t n, VecHit& outHits) const
+{
+    outHits.clear();
+    if (!n || !numAc)
+        return 0;
+    const double kx = 60.0 * std::cos(lat0 * 3.14159265358979323846 / 180.0);
+    const uint64_t cell = cellOf(lat0, lon0);
+    const int64_t cy = int64_t(cell / nx);
+    const int64_t cx = int64_t(cell % nx);
+    // an aircraft outside ring `r` is at least `r` cells away in lat or lon
+    const double nmPerRing = cellDeg * std::min(60.0, kx);
+    auto byDist = [](const Hit& a, const Hit& b) { return a.dist_nm < b.dist_nm; };
+    
+    for (int64_t r = 0; ; r++)
+    {
+        // Ring wraps around the globe? Then simply take everything
+        if (uint64_t(2 * r + 1) >= nx) {
+            outHits.clear();
+            for (const auto& c: mapCells)
+                collect(c.first / nx, c.first % nx, lat0, lon0, kx, HUGE_VAL, outHits);
+            break;
+        }
+        
+        // visit all cells on ring `r`
+        for (int64_t dy = -r; dy <= r; dy++) {
+            const int64_t iy = cy + dy;
+            if (iy < 0 || iy >= int64_t(ny)) continue;
+            const int64_t step = (dy == -r || dy == r) ? 1 : 2 * r;
+            for (int64_t dx = -r; dx <= r; dx += std::max<int64_t>(step, 1))
+                collect(uint64_t(iy), uint64_t((cx + dx + int64_t(nx)) % int64_t(nx)),
+                        lat0, lon0, kx, HUGE_VAL, outHits);
+        }
+        
+        // found all there is?
+        if (outHits.size() >= numAc)
+            break;
+        // enough found, and none of the unvisited cells can contain a closer one?
+        if (outHits.size() >= n) {
+            std::nth_element(outHits.begin(), outHits.begin() + long(n - 1), outHits.end(), byDist);
+            if (outHits[n - 1].dist_nm <= double(r) * nmPerRing)
+                break;
+        }
+    }
+    
+    // sort the closest n
+    const size_t num = std::min(n, outHits.size());
+    std::partial_sort(outHits.begin(), outHits.begin() + long(num), outHits.end(), byDist);
+    outHits.resize(num);
+    return num;
+}
+
+//
+// MARK: LTAPIReplay
+//
+
+/// @brief Read access to a capture file, which is memory-mapped
+/// @details A capture file consists of a FileHdr followed by records.
+///          Each record is a RecHdr followed by `numBytes` of raw data
+///          as received from LiveTraffic, padded to 8 bytes,
+///          so that data can be used in place as LTAPIBulkData or LTAPIBulkInfoTexts.
+class LTAPIReplay
+{
+public:
+    /// Record types
+    enum RecTy : uint32_t {
+        REC_CYCLE = 1,                  ///< start of an UpdateAcList() cycle, `offset` is the number of aircraft
+        REC_QUICK,                      ///< raw `livetraffic/bulk/quick` data
+        REC_EXPSV,                      ///< raw `livetraffic/bulk/expensive` data
+    };
+    
+    /// File header
+    struct FileHdr {
+        char        magic[8];           ///< "LTAPICAP"
+        uint32_t    version;            ///< file format version
+        uint32_t    sizeBulk;           ///< `sizeof(LTAPIBulkData)` of the recording LTAPI
+        uint32_t    sizeInfo;           ///< `sizeof(LTAPIBulkInfoTexts)` of the recording LTAPI
+        uint32_t    filler;             ///< keeps 8 byte alignment
+    };
+    
+    /// Record header, directly followed by the record's data
+    struct RecHdr {
+        uint32_t    type;               ///< record type, see RecTy
+        int32_t     sizeLT;             ///< struct size LiveTraffic returned in size negotiation
+        int32_t     offset;             ///< offset (in number of aircraft) of the first aircraft
+        int32_t     numBytes;           ///< number of data bytes following
+        int64_t     ts_us;              ///< [µs] timestamp since start of recording
+    };
+    
+    /// Capture file magic
+    static constexpr const char* MAGIC = "LTAPICAP";
+    /// Current file format version
+    static constexpr uint32_t VERSION = 1;
+    
+    /// Size of record incl. padding
+    static size_t RecSize (const RecHdr& rec)
+    { return sizeof(RecHdr) + ((size_t(rec.numBytes) + 7) & ~size_t(7)); }
+    
+protected:
+    const char* pData = nullptr;        ///< mapped file
+    size_t      dataSize = 0;           ///< size of mapped file
+    size_t      pos = sizeof(FileHdr);  ///< read position
+#if IBM
+    HANDLE      hFile = INVALID_HANDLE_VALUE;   ///< file handle
+    HANDLE      hMap = NULL;                    ///< file mapping handle
+#endif
+    
+public:
+    /// Destructor unmaps the file
+    ~LTAPIReplay ()
+    {
+#if IBM
+        if (pData) UnmapViewOfFile(pData);
+        if (hMap) CloseHandle(hMap);
+        if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+#else
+        if (pData) munmap((void*)pData, dataSize);
+#endif
+    }
+    
+    /// Maps the file and validates its header
+    bool Open (const std::string& path)
+    {
+#if IBM
+        hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (hFile == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(hFile, &sz) || sz.QuadPart < LONGLONG(sizeof(FileHdr))) return false;
+        dataSize = size_t(sz.QuadPart);
+        hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!hMap) return false;
+        pData = (const char*)MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+#else
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < off_t(sizeof(FileHdr))) { close(fd); return false; }
+        dataSize = size_t(st.st_size);
+        void* p = mmap(nullptr, dataSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);                      // mapping stays valid
+        pData = p == MAP_FAILED ? nullptr : (const char*)p;
+#endif
+        if (!pData) return false;
+        
+        // Validate the header: we can only replay data of same structure sizes
+        const FileHdr& hdr = *reinterpret_cast<const FileHdr*>(pData);
+        return
+            !memcmp(hdr.magic, MAGIC, sizeof(hdr.magic)) &&
+            hdr.version  == VERSION &&
+            hdr.sizeBulk == sizeof(LTAPIAircraft::LTAPIBulkData) &&
+            hdr.sizeInfo == sizeof(LTAPIAircraft::LTAPIBulkInfoTexts);
+    }
+    
+    /// Next record, or `nullptr` if at end
+    const RecHdr* Peek () const
+    {
+        if (pos + sizeof(RecHdr) > dataSize) return nullptr;
+        const RecHdr* pRec = reinterpret_cast<const RecHdr*>(pData + pos);
+        if (pRec->numBytes < 0 || pos + RecSize(*pRec) > dataSize) return nullptr;
+        return pRec;
+    }
+    
+    /// Skips forward to the next cycle and returns its number of aircraft, `-1` if at end
+    int NextCycle ()
+    {
+        for (const RecHdr* pRec = Peek(); pRec; pRec = Peek()) {
+            pos += RecSize(*pRec);
+            if (pRec->type == REC_CYCLE)
+                return pRec->offset;
+        }
+        return -1;
+    }
+    
+    /// Returns the next record and moves on if it is bulk data of the requested type, otherwise returns `nullptr`
+    const RecHdr* NextBulk (bool bQuick)
+    {
+        const RecHdr* pRec = Peek();
+        if (!pRec || pRec->type != uint32_t(bQuick ? REC_QUICK : REC_EXPSV))
+            return nullptr;
+        pos += RecSize(*pRec);
+        return pRec;
+    }
+    
+    /// Is the next record expensive bulk data?
+    bool isNextExpsv () const
+    {
+        const RecHdr* pRec = Peek();
+        return pRec && pRec->type == REC_EXPSV;
+    }
+    
+    /// Reached end of capture?
+    bool isAtEnd () const { return Peek() == nullptr; }
+    
+    /// Restart from the first record
+    void Rewind () { pos = sizeof(FileHdr); }
+};
+
+//
+// MARK: LTAPIStatsDataRefs
+//
+
+/// Own read-only dataRefs publishing LTAPIConnect's statistics
+class LTAPIStatsDataRefs
+{
+public:
+    /// Published values, index into `val`
+    enum ValIdx {
+        V_AIRCRAFT = 0,
+        V_UPDATE_US,
+        V_UPDATE_US_P50,
+        V_UPDATE_US_P99,
+        V_GETDATA_US,
+        V_GETDATA_CALLS,
+        V_BYTES_PER_SEC,
+        V_CREATED,
+        V_REMOVED,
+        V_HINT_HIT_RATE,
+        V_NUM
+    };
+    
+protected:
+    float       val[V_NUM] = {0};           ///< current values, read by the dataRef accessors
+    XPLMDataRef aDR[V_NUM] = {NULL};        ///< registered dataRefs
+    /// Start of current transfer rate measurement period
+    std::chrono::steady_clock::time_point tsRate = std::chrono::steady_clock::now();
+    uint64_t    bytesRate = 0;              ///< total bytes at start of transfer rate measurement period
+    
+    /// dataRef accessor returning the value as int
+    static int GetInt (void* refcon)        { return int(*reinterpret_cast<const float*>(refcon)); }
+    /// dataRef accessor returning the value as float
+    static float GetFloat (void* refcon)    { return *reinterpret_cast<const float*>(refcon); }
+    
+public:
+    /// Registers all dataRefs as `ltapi/<pluginName>/...`
+    LTAPIStatsDataRefs (const std::string& pluginName)
+    {
+        static const char* NAMES[V_NUM] = {
+            "aircraft", "update_us", "update_us_p50", "update_us_p99",
+            "getdata_us", "getdata_calls", "bytes_per_sec",
+            "created", "removed", "hint_hit_rate"
+        };
+        const XPLMPluginID idDRT = XPLMFindPluginBySignature("com.leecbaker.datareftool");
+        for (int i = 0; i < V_NUM; i++) {
+            const std::string name = "ltapi/" + pluginName + '/' + NAMES[i];
+            aDR[i] = XPLMRegisterDataAccessor(name.c_str(), xplmType_Int | xplmType_Float, 0,
+                                              GetInt, NULL, GetFloat, NULL,
+                                              NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                                              &val[i], NULL);
+            // Tell DataRefTool about it (message 0x01000000 = "add dataRef")
+            if (idDRT != XPLM_NO_PLUGIN_ID)
+                XPLMSendMessageToPlugin(idDRT, 0x01000000, (void*)name.c_str());
+        }
+    }
+    
+    /// Unregisters all dataRefs
+    ~LTAPIStatsDataRefs ()
+    {
+        for (XPLMDataRef& dr: aDR)
+            if (dr) XPLMUnregisterDataAccessor(dr);
+    }
+    
+    /// Refreshes values, called at the end of each UpdateAcList() call
+    void Refresh (const LTAPIConnect& lt)
+    {
+        const LTAPIConnect::Stats& stats = lt.getStats();
+        val[V_AIRCRAFT]         = float(lt.getAcMapNum().size());
+        val[V_UPDATE_US]        = float(stats.last.nsTotal) / 1000.0f;
+        val[V_GETDATA_US]       = float(stats.last.nsQuick + stats.last.nsExpsv) / 1000.0f;
+        val[V_GETDATA_CALLS]    = float(stats.last.numGetData);
+        val[V_CREATED]          = float(stats.total.numCreated);
+        val[V_REMOVED]          = float(stats.total.numRemoved);
+        
+        // The more expensive values only once a second
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const std::chrono::duration<float> dt = now - tsRate;
+        if (dt.count() >= 1.0f) {
+            const uint64_t bytes = stats.total.bytesQuick + stats.total.bytesExpsv;
+            val[V_BYTES_PER_SEC]    = float(bytes - bytesRate) / dt.count();
+            val[V_UPDATE_US_P50]    = float(stats.getLatPercentile(0.50)) / 1000.0f;
+            val[V_UPDATE_US_P99]    = float(stats.getLatPercentile(0.99)) / 1000.0f;
+            val[V_HINT_HIT_RATE]    = float(lt.getHintHitRate());
+            tsRate = now;
+            bytesRate = bytes;
+        }
+    }
+};
+
+//
+// MARK: LTAPITextIndex
+//
+
+/// @brief Hashed indexes by call sign, registration, and flight number
+/// @details All three fields are 8 byte char arrays in LTAPIBulkInfoTexts,
+///          so their content packed into a `uint64_t` serves as hash key
+///          without any string handling.
+class LTAPITextIndex
+{
+public:
+    /// Indexed fields
+    enum FieldTy {
+        TI_CALLSIGN = 0,                ///< LTAPIBulkInfoTexts::callSign
+        TI_REG,                         ///< LTAPIBulkInfoTexts::registration
+        TI_FLIGHTNO,                    ///< LTAPIBulkInfoTexts::flightNumber
+        TI_NUM
+    };
+    /// Packed keys of all indexed fields of one aircraft
+    typedef uint64_t KeysTy[TI_NUM];
+    
+protected:
+    /// One hash map per field, multimap as texts need not be unique
+    std::unordered_multimap<uint64_t, LTAPIAircraft*> aMap[TI_NUM];
+    
+public:
+    /// Packs up to 8 chars into a `uint64_t`, stops at the first zero char
+    static uint64_t Pack (const char* s, size_t len)
+    {
+        char buf[8] = {0,0,0,0,0,0,0,0};
+        for (size_t i = 0; i < len && i < sizeof(buf) && s[i]; i++)
+            buf[i] = s[i];
+        uint64_t key = 0;
+        memcpy(&key, buf, sizeof(key));
+        return key;
+    }
+    
+    /// Packed keys of an aircraft's current texts
+    static void GetKeys (const LTAPIAircraft& ac, KeysTy& keys)
+    {
+        keys[TI_CALLSIGN]   = Pack(ac.info.callSign,        sizeof(ac.info.callSign));
+        keys[TI_REG]        = Pack(ac.info.registration,    sizeof(ac.info.registration));
+        keys[TI_FLIGHTNO]   = Pack(ac.info.flightNumber,    sizeof(ac.info.flightNumber));
+    }
+    
+    /// Could updating an aircraft with `info` change its keys? (Cheaper than GetKeys())
+    static bool MayChangeKeys (const LTAPIAircraft& ac, const LTAPIAircraft::LTAPIBulkInfoTexts& info)
+    {
+        return memcmp(ac.info.callSign,     info.callSign,      sizeof(info.callSign))      ||
+               memcmp(ac.info.registration, info.registration,  sizeof(info.registration))  ||
+               memcmp(ac.info.flightNumber, info.flightNumber,  sizeof(info.flightNumber));
+    }
+    /// Numeric data never changes keys
+    static bool MayChangeKeys (const LTAPIAircraft&, const LTAPIAircraft::LTAPIBulkData&)
+    { return false; }
+    
+    /// Adds an aircraft to the index of one field, empty texts are not indexed
+    void insert (FieldTy f, uint64_t key, LTAPIAircraft* pAc)
+    {
+        if (key)
+            aMap[f].emplace(key, pAc);
+    }
+    
+    /// Removes an aircraft from the index of one field
+    void erase (FieldTy f, uint64_t key, const LTAPIAircraft* pAc)
+    {
+        if (!key) return;
+        auto range = aMap[f].equal_range(key);
+        for (auto iter = range.first; iter != range.second; ++iter)
+            if (iter->second == pAc) {
+                aMap[f].erase(iter);
+                return;
+            }
+    }
+    
+    /// Adds an aircraft with its current texts
+    void insert (LTAPIAircraft* pAc)
+    {
+        KeysTy keys;
+        GetKeys(*pAc, keys);
+        for (int f = 0; f < TI_NUM; f++)
+            insert(FieldTy(f), keys[f], pAc);
+    }
+    
+    /// Removes an aircraft, which is indexed with its current texts
+    void erase (const LTAPIAircraft* pAc)
+    {
+        KeysTy keys;
+        GetKeys(*pAc, keys);
+        for (int f = 0; f < TI_NUM; f++)
+            erase(FieldTy(f), keys[f], pAc);
+    }
+    
+    /// Re-indexes those fields of an aircraft, which changed compared to `oldKeys`
+    void update (LTAPIAircraft* pAc, const KeysTy& oldKeys)
+    {
+        KeysTy newKeys;
+        GetKeys(*pAc, newKeys);
+        for (int f = 0; f < TI_NUM; f++)
+            if (newKeys[f] != oldKeys[f]) {
+                erase(FieldTy(f), oldKeys[f], pAc);
+                insert(FieldTy(f), newKeys[f], pAc);
+            }
+    }
+    
+    /// Removes all aircraft
+    void clear ()
+    {
+        for (auto& m: aMap)
+            m.clear();
+    }
+    
+    /// All entries with exact text, in no particular order
+    std::pair<std::unordered_multimap<uint64_t, LTAPIAircraft*>::const_iterator,
+              std::unordered_multimap<uint64_t, LTAPIAircraft*>::const_iterator>
+    equal_range (FieldTy f, const std::string& s) const
+    {
+        if (s.empty() || s.size() > 8)
+            return std::make_pair(aMap[f].end(), aMap[f].end());
+        return aMap[f].equal_range(Pack(s.data(), s.size()));
+    }
+    
+    /// @brief Finds an aircraft by exact text
+    /// @details If several aircraft share the text, the one with the lowest key
+    ///          (instead of whichever the multimap happens to return first)
+    LTAPIAircraft* find (FieldTy f, const std::string& s) const
+    {
+        LTAPIAircraft* pFound = nullptr;
+        const auto range = equal_range(f, s);
+        for (auto iter = range.first; iter != range.second; ++iter)
+            if (!pFound || iter->second->keyNum < pFound->keyNum)
+                pFound = iter->second;
+        return pFound;
+    }
+};
+
+//
+// MARK: LTAPIConnect
+//
+
+LTAPIConnect::LTAPIConnect(fCreateAcObject* _pfCreateAcObject, int numBulkAc) :
+// clamp numBulkAc between 1 and 100
+iBulkAc(numBulkAc < 1 ? 1 : numBulkAc > 100 ? 100 : numBulkAc),
+// reserve memory for bulk data transfer from LiveTraffic
+vBulkNum (new LTAPIAircraft::LTAPIBulkData[iBulkAc]),
+vInfoTexts(new LTAPIAircraft::LTAPIBulkInfoTexts[iBulkAc]),
+pfCreateAcObject(_pfCreateAcObject)
+{
+    // Create the shared dataRefs to access camera aircraft event notifications
+    XPLMShareData(SDR_CAMERA_MODES_ID, xplmType_Int, nullptr, nullptr);
+    XPLMShareData(SDR_CAMERA_TCAS_IDX, xplmType_Int, (XPLMDataChanged_f)(&LTAPIConnect::CameraSharedDataCB), this);
+}
+
+LTAPIConnect::LTAPIConnect(fCreateAcShared* _pfCreateAcShared, int numBulkAc) :
+LTAPIConnect(static_cast<fCreateAcObject*>(nullptr), numBulkAc)
+{
+    pfCreateAcShared = _pfCreateAcShared;
+    spPool = std::make_shared<LTAPIAcPool>();
+}
+
+LTAPIConnect::~LTAPIConnect()
+{
+    StopRecording();
+    XPLMUnshareData(SDR_CAMERA_MODES_ID, xplmType_Int, nullptr, nullptr);
+    XPLMUnshareData(SDR_CAMERA_TCAS_IDX, xplmType_Int, (XPLMDataChanged_f)(&LTAPIConnect::CameraSharedDataCB), this);
+}
+
+// LiveTraffic available? (checks via XPLMFindPluginBySignature)
+bool LTAPIConnect::isLTAvail ()
+{
+    return XPLMFindPluginBySignature(LT_PLUGIN_SIGNATURE) != XPLM_NO_PLUGIN_ID;
+}
+
+// LiveTraffic's version number
+int LTAPIConnect::getLTVerNr()
+{
+    static LTDataRef DRVerNr("livetraffic/ver/nr");
+    if (!isLTAvail())                   // LiveTraffic unavailable?
+        return 0;
+    if (DRVerNr.isValid())              // Can fetch version number from LT?
+        return DRVerNr.getInt();
+    else
+        return 150;
+}
+
+/// @brief LiveTraffic's version date
+/// @details Version date became available with v2.01 only. This is why 20191231 is returned in case
+///          LiveTraffic is available, but not the dataRef to fetch the date from.
+/// @return Version date (like 20200430 for 30-APR-2020), or constant 20191231 if unknown, or 0 if LiveTraffic is unavailable
+int LTAPIConnect::getLTVerDate()
+{
+    static LTDataRef DRVerDate("livetraffic/ver/date");
+    if (!isLTAvail())                   // LiveTraffic unavailable?
+        return 0;
+    if (DRVerDate.isValid())            // Can fetch version date from LT?
+        return DRVerDate.getInt();
+    else
+        return 20191231;
+}
+
+
+// Does LiveTraffic display aircrafts? (Is it activated?)
+bool LTAPIConnect::doesLTDisplayAc ()
+{
+    static LTDataRef DRAcDisplayed("livetraffic/cfg/aircrafts_displayed");
+    // this is the only function which tries to find the dataRef over and over again
+    if (!DRAcDisplayed.isValid())
+        DRAcDisplayed.FindDataRef();
+    return DRAcDisplayed.getBool();
+}
+
+// How many of them right now?
+int LTAPIConnect::getLTNumAc ()
+{
+    RETURN_DR("livetraffic/ac/num",Int);
+}
+
+// Does it (also) control AI planes?
+bool LTAPIConnect::doesLTControlAI ()
+{
+    RETURN_DR("livetraffic/cfg/ai_controlled",Bool);
+}
+
+// What's current simulated time in LiveTraffic (usually 'now' minus buffering period)?
+time_t LTAPIConnect::getLTSimTime ()
+{
+    struct tm t;
+    memset(&t, 0, sizeof(t));
+    
+    int i = 0;
+    ASSIGN_DR_NAME(i, Date, "livetraffic/sim/date", Int);
+    t.tm_year = i / 10000;
+    i -= t.tm_year * 10000;
+    t.tm_mon = i / 100 - 1;
+    t.tm_mday = i % 100;
+
+    ASSIGN_DR_NAME(i, Time, "livetraffic/sim/time", Int);
+    t.tm_hour   = i / 10000;
+    t.tm_min    = (i % 10000) / 100;
+    t.tm_sec    = i % 100;
+    
+    return LTAPI::timegm(&t);
+}
+
+std::chrono::system_clock::time_point LTAPIConnect::getLTSimTimePoint ()
+{
+    return std::chrono::system_clock::from_time_t(getLTSimTime());
+}
+
+
+const MapLTAPIAircraft& LTAPIConnect::UpdateAcList (ListLTAPIAircraft* plistRemovedAc)
+{
+    // First call of the string-keyed variant? Then build up the string map once,
+    // from then on it is maintained incrementally whenever aircraft come or go
+    if (!bMapStr) {
+        bMapStr = true;
+        for (const MapLTAPIAircraftNum::value_type& p: mapAcNum)
+            mapAc.emplace(p.second->getKey(), p.second);
+    }
+    DoUpdateAcList(plistRemovedAc);
+    return mapAc;
+}
+
+const MapLTAPIAircraftNum& LTAPIConnect::UpdateAcListNum (ListLTAPIAircraft* plistRemovedAc)
+{
+    DoUpdateAcList(plistRemovedAc);
+    return mapAcNum;
+}
+
+const MapLTAPIAircraftNum& LTAPIConnect::UpdateAcListNumVec (VecLTAPIAircraft* pvecRemovedAc)
+{
+    DoUpdateAcList(pvecRemovedAc);
+    return mapAcNum;
+}
+
+template <class ContT>
+void LTAPIConnect::DoUpdateAcList (ContT* pRemovedAc)
+{
+    // These are the bulk input/output dataRefs in LiveTraffic,
+    // with which we fetch mass data from LiveTraffic
+    static LTDataRef DRquick("livetraffic/bulk/quick");
+    static LTDataRef DRexpsv("livetraffic/bulk/expensive");
+    LTAPI_STATS_DO(statsCall = UpdateStats());
+    LTAPI_STATS_DO(const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now());
+    if (bEvents) {
+        vEvents.clear();                // keeps its capacity
+        evCycle++;
+    }
+
+    // a few sanity checks...without LT displaying aircrafts
+    // and access to ac/key there is nothing to do.
+    // (Calling doesLTDisplayAc before calling any other dataRef
+    //  makes sure we only try accessing dataRefs when they are available.)
+    int numAc = 0;
+    if (pReplay)                        // replaying a capture file?
+        numAc = std::max(pReplay->NextCycle(), 0);
+    else {
+        numAc = isLTAvail() && doesLTDisplayAc() && DRquick.isValid() && DRexpsv.isValid() ? getLTNumAc() : 0;
+        if (fCapture)                   // recording? Each cycle starts with the number of aircraft
+            WriteCaptureRec(LTAPIReplay::REC_CYCLE, 0, numAc, nullptr, 0);
+    }
+    if (numAc <= 0) {
+        // does caller want to know about removed aircrafts?
+        if (pRemovedAc)
+            for (MapLTAPIAircraftNum::value_type& p: mapAcNum)
+                // move all objects over to the caller's list's end
+                pRemovedAc->emplace_back(std::move(p.second));
+        LTAPI_STATS_DO(statsCall.numRemoved = mapAcNum.size());
+        if (bEvents)
+            for (const MapLTAPIAircraftNum::value_type& p: mapAcNum) {
+                LTAPIAcEvent e;
+                e.keyNum = p.first;
+                e.ev = LTAPIAcEvent::EV_REMOVED;
+                vEvents.push_back(e);
+            }
+        // clear our maps (and the hint cache pointing into them)
+        cols.clear();                   // before releasing the objects they refer to
+        grid.clear();
+        if (pTextIdx) pTextIdx->clear();
+        std::fill(std::begin(aMultiIdxAc), std::end(aMultiIdxAc), nullptr);
+        std::fill(std::begin(aMultiIdxAcNext), std::end(aMultiIdxAcNext), nullptr);
+        pCameraAc = pCameraAcNext = nullptr;
+        mapAcNum.clear();
+        mapAc.clear();
+        std::fill(vHint.begin(), vHint.end(), nullptr);
+        std::fill(vHintNext.begin(), vHintNext.end(), nullptr);
+        sweepAc = 0;
+        bSweepExpsv = false;
+        vNewAcIdx.clear();
+        if (bSnapshots) PublishSnapshot();
+        LTAPI_STATS_DO(StatsFinishCall(tStart));
+        if (pStatsDR) pStatsDR->Refresh(*this);
+        if (bEvents) NotifyEvents();
+        return;
+    }
+    
+    // *** There are numAc aircrafts to be reported ***
+    
+    // Without a budget (always when recording or replaying) each call is a complete sweep
+    const bool bBudget = usUpdateBudget.count() > 0 && !fCapture && !pReplay;
+    const std::chrono::time_point<std::chrono::steady_clock> tDeadline =
+        bBudget ? std::chrono::steady_clock::now() + usUpdateBudget :
+        std::chrono::time_point<std::chrono::steady_clock>::max();
+    if (!bBudget) {
+        sweepAc = 0;
+        bSweepExpsv = false;
+    }
+    
+    // Level of detail: between full fetches only fetch aircraft due in their tier,
+    // but any change in the number of aircraft requires a full fetch
+    bool bLODCall = false;
+    if (bLOD && !bBudget && !fCapture && !pReplay) {
+        bLODCall = numAc == sweepNumAc && ++lodCall % lodFullIntvl != 0;
+        if (bLODCall)
+            PlanLODRanges(numAc);
+        else
+            lodCall = 0;
+    }
+    
+    if (isSweepComplete()) {
+        // To figure out which aircraft has gone we keep an update flag
+        // with the aircraft. Let's reset that flag at the beginning of a sweep.
+        // (All flags, also in level-of-detail calls, so that they tell what was fetched.)
+        for (MapLTAPIAircraftNum::value_type& p: mapAcNum)
+            p.second->resetUpdated();
+        bSweepNewAc = false;
+    }
+    sweepNumAc = numAc;
+    
+    // The hint cache needs one slot per bulk offset
+    // (plus one bulk extra in case LT returns more than it said)
+    if (vHint.size() < size_t(numAc + iBulkAc)) {
+        vHint.resize(size_t(numAc + iBulkAc), nullptr);
+        vHintNext.resize(size_t(numAc + iBulkAc), nullptr);
+    }
+    
+    // *** Read bulk info from LiveTraffic ***
+    
+    // Always do the rather fast call for numeric data
+    int sizeLTStruct = 0;                     // not yet used, will become important once different versions exist
+    // When replaying we do the expensive call exactly when it was recorded, sliced or not
+    const bool bSliced = bSliceExpsv && !pReplay;
+    if (!bSweepExpsv) {
+        const uint64_t numMissesBefore = numHintMisses;
+        bSweepNewAc |= DoBulkFetch<LTAPIAircraft::LTAPIBulkData>(numAc, DRquick, sizeLTStruct,
+                                                                 vBulkNum, sweepAc, tDeadline,
+                                                                 bLODCall ? &vLODRanges : nullptr);
+        // Aircraft not at their previous offsets during a level-of-detail call?
+        // Then LT's list has changed and DoBulkFetch() has completed a full fetch instead.
+        if (bLODCall && numHintMisses != numMissesBefore) {
+            bLODCall = false;
+            lodCall = 0;
+        }
+        // Numeric fetch complete?
+        if (sweepAc == 0 && !bSliced &&
+            (pReplay ? pReplay->isNextExpsv() :
+             // do the expensive call for textual data if the above one added new objects, OR
+             // if 3 seconds have passed since the last call
+             bSweepNewAc || std::chrono::steady_clock::now() - lastExpsvFetch > sPeriodExpsv))
+            bSweepExpsv = true;
+    }
+    
+    // Expensive call for textual data, unless the budget is already used up
+    if (bSweepExpsv && std::chrono::steady_clock::now() < tDeadline)
+    {
+        sizeLTStruct = 0;
+        DoBulkFetch<LTAPIAircraft::LTAPIBulkInfoTexts>(numAc, DRexpsv, sizeLTStruct,
+                                                       vInfoTexts, sweepAc, tDeadline);
+        if (sweepAc == 0) {
+            bSweepExpsv = false;
+            lastExpsvFetch = std::chrono::steady_clock::now();
+            LTAPI_STATS_DO(statsCall.numExpsv = 1);
+        }
+    }
+    
+    // Sliced expensive call: texts of new aircraft plus the next slice, if the budget allows
+    if (bSliced) {
+        PlanExpsvSlice(numAc, std::chrono::steady_clock::now() < tDeadline);
+        if (!vExpsvRanges.empty()) {
+            sizeLTStruct = 0;
+            int acUnused = 0;
+            DoBulkFetch<LTAPIAircraft::LTAPIBulkInfoTexts>(numAc, DRexpsv, sizeLTStruct,
+                                                           vInfoTexts, acUnused, tDeadline,
+                                                           &vExpsvRanges);
+            LTAPI_STATS_DO(statsCall.numExpsv = 1);
+        }
+    }
+    vNewAcIdx.clear();
+        
+    // Sweep complete? Then the slot table and camera aircraft it built replace the previous ones
+    if (isSweepComplete() && !bLODCall) {
+        std::copy(std::begin(aMultiIdxAcNext), std::end(aMultiIdxAcNext), std::begin(aMultiIdxAc));
+        pCameraAc = pCameraAcNext;
+    }
+    
+    // ***  Now handle aircrafts in our map, which did _not_ get updated during the sweep ***
+    for (MapLTAPIAircraftNum::iterator iter = mapAcNum.begin();
+         isSweepComplete() && !bLODCall && iter != mapAcNum.end();
+         /* no loop increment*/)
+    {
+        // not updated?
+        if (!iter->second->isUpdated()) {
+            // remove from the string map, too, if we maintain it
+            if (bMapStr)
+                mapAc.erase(iter->second->getKey());
+            // remove from the column view and grid index, too
+            if (bCols)
+                ColRemove(iter->second.get());
+            if (bGrid)
+                grid.remove(iter->second.get());
+            if (pTextIdx)
+                pTextIdx->erase(iter->second.get());
+            if (bEvents)
+                AddEvent(iter->second.get(), LTAPIAcEvent::EV_REMOVED);
+            // Does caller want to take over them?
+            if (pRemovedAc)
+                // here you go...your object now
+                pRemovedAc->emplace_back(std::move(iter->second));
+            // in any case: remove from our map and increment to next element
+            iter = mapAcNum.erase(iter);
+            LTAPI_STATS_DO(statsCall.numRemoved++);
+        }
+        else
+            // go to next element (without removing this one)
+            iter++;
+    }
+    
+    if (bSnapshots) PublishSnapshot();
+    LTAPI_STATS_DO(StatsFinishCall(tStart));
+    if (pStatsDR) pStatsDR->Refresh(*this);
+    if (bEvents) NotifyEvents();
+}
+
+// Finds an aircraft for a given multiplayer slot
+SPtrLTAPIAircraft LTAPIConnect::getAcByMultIdx (int multiIdx) const
+{
+    // sanity check: 0 is no slot at all
+    if (multiIdx < 1 || multiIdx >= MAX_MULTI_IDX)
+        return SPtrLTAPIAircraft();
+    return getSPtr(aMultiIdxAc[multiIdx]);
+}
+
+
+// Returns the aircraft being viewed in LiveTraffic's camera view, if any
+SPtrLTAPIAircraft LTAPIConnect::getAcInCameraView() const
+{
+    return getSPtr(pCameraAc);
+}
+
+
+// Creates a new aircraft object via the creation callback
+SPtrLTAPIAircraft LTAPIConnect::CreateAc ()
+{
+    if (pfCreateAcShared)
+        return pfCreateAcShared(spPool);
+    assert(pfCreateAcObject);
+    return SPtrLTAPIAircraft(pfCreateAcObject());
+}
+
+// Returns the smart pointer to an aircraft in `mapAcNum`
+SPtrLTAPIAircraft LTAPIConnect::getSPtr (const LTAPIAircraft* pAc) const
+{
+    if (!pAc)
+        return SPtrLTAPIAircraft();
+    MapLTAPIAircraftNum::const_iterator iter = mapAcNum.find(pAc->keyNum);
+    return iter == mapAcNum.cend() ? SPtrLTAPIAircraft() : iter->second;
+}
+
+
+// Start recording all raw bulk data received into a capture file
+bool LTAPIConnect::StartRecording (const std::string& path)
+{
+    StopRecording();
+    fCapture = fopen(path.c_str(), "wb");
+    if (!fCapture)
+        return false;
+    
+    // File header
+    LTAPIReplay::FileHdr hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, LTAPIReplay::MAGIC, sizeof(hdr.magic));
+    hdr.version  = LTAPIReplay::VERSION;
+    hdr.sizeBulk = sizeof(LTAPIAircraft::LTAPIBulkData);
+    hdr.sizeInfo = sizeof(LTAPIAircraft::LTAPIBulkInfoTexts);
+    if (fwrite(&hdr, sizeof(hdr), 1, fCapture) != 1) {
+        StopRecording();
+        return false;
+    }
+    tsCaptureStart = std::chrono::steady_clock::now();
+    return true;
+}
+
+// Stop recording and close the capture file
+void LTAPIConnect::StopRecording ()
+{
+    if (fCapture) {
+        fclose(fCapture);
+        fCapture = nullptr;
+    }
+}
+
+// Replay a capture file instead of fetching data from LiveTraffic
+bool LTAPIConnect::StartReplay (const std::string& path)
+{
+    pReplay.reset(new LTAPIReplay());
+    if (!pReplay->Open(path)) {
+        pReplay.reset();
+        return false;
+    }
+    return true;
+}
+
+// Stop replaying, return to fetching live data from LiveTraffic
+void LTAPIConnect::StopReplay ()
+{
+    pReplay.reset();
+}
+
+// Has replay reached the end of the capture file?
+bool LTAPIConnect::isReplayAtEnd () const
+{
+    return pReplay && pReplay->isAtEnd();
+}
+
+// Restart replay from the beginning of the capture file
+void LTAPIConnect::RewindReplay ()
+{
+    if (pReplay)
+        pReplay->Rewind();
+}
+
+// Write one record to the capture file
+void LTAPIConnect::WriteCaptureRec (uint32_t type, int sizeLT, int offset,
+                                    const void* pData, int numBytes)
+{
+    static const char padding[8] = {0,0,0,0,0,0,0,0};
+    LTAPIReplay::RecHdr rec;
+    rec.type     = type;
+    rec.sizeLT   = sizeLT;
+    rec.offset   = offset;
+    rec.numBytes = numBytes;
+    rec.ts_us    = std::chrono::duration_cast<std::chrono::microseconds>
+                   (std::chrono::steady_clock::now() - tsCaptureStart).count();
+    const size_t pad = LTAPIReplay::RecSize(rec) - sizeof(rec) - size_t(numBytes);
+    if (fwrite(&rec, sizeof(rec), 1, fCapture) != 1 ||
+        (numBytes > 0 && fwrite(pData, size_t(numBytes), 1, fCapture) != 1) ||
+        (pad > 0 && fwrite(padding, pad, 1, fCapture) != 1))
+        StopRecording();                // stop recording on write errors, e.g. disk full
+}
+
+
+// Enables maintaining a structure-of-arrays view of all aircraft
+void LTAPIConnect::EnableColumns (bool bEnable)
+{
+    bCols = bEnable;
+    cols.clear();
+    if (!bEnable)
+        cols.bHist = false;
+    for (MapLTAPIAircraftNum::value_type& p: mapAcNum) {
+        p.second->iCol = -1;
+        if (bEnable)
+            cols.push_back(p.second.get());
+    }
+}
+
+// Enables buffering samples for interpolation
+void LTAPIConnect::EnableInterpolation (bool bEnable)
+{
+    if (bEnable == cols.bHist)
+        return;
+    cols.bHist = bEnable;
+    if (!bEnable)
+        cols.hist.clear();
+    else if (!bCols)
+        EnableColumns();
+    else {
+        // start with the current values as first sample
+        cols.hist.resize(cols.size());
+        for (size_t i = 0; i < cols.size(); i++)
+            cols.set(i);
+    }
+}
+
+// Converts positions of all aircraft to local coordinates
+size_t LTAPIConnect::UpdateLocalCoords ()
+{
+    if (!bCols)
+        return 0;
+    // (Re)calibrate if never done or if X-Plane moved its local origin,
+    // which invalidates all cached coordinates by means of the new generation
+    if (!localFrame.gen || localFrame.isShifted())
+        localFrame.calibrate();
+    
+    size_t num = 0;
+    const uint32_t gen = localFrame.gen;
+    for (size_t i = 0; i < cols.size(); i++) {
+        if (cols.localGen[i] == gen)
+            continue;
+        localFrame.toLocal(cols.lat[i], cols.lon[i], cols.alt_ft[i] * 0.3048,
+                           cols.x[i], cols.y[i], cols.z[i]);
+        cols.localGen[i] = gen;
+        num++;
+    }
+    return num;
+}
+
+// Removes an aircraft's row from `cols`
+void LTAPIConnect::ColRemove (LTAPIAircraft* pAc)
+{
+    if (pAc->iCol < 0) return;
+    LTAPIAircraft* pMoved = cols.swapRemove(size_t(pAc->iCol));
+    if (pMoved)
+        pMoved->iCol = pAc->iCol;
+    pAc->iCol = -1;
+}
+
+// Enables maintaining a spatial grid index of all aircraft
+void LTAPIConnect::EnableGrid (bool bEnable, double cellDeg)
+{
+    bGrid = bEnable;
+    grid.init(cellDeg);
+    if (bEnable)
+        for (MapLTAPIAircraftNum::value_type& p: mapAcNum)
+            grid.insert(p.second.get());
+}
+
+// Enables hashed indexes by call sign, registration, and flight number
+void LTAPIConnect::EnableTextIndex (bool bEnable)
+{
+    pTextIdx.reset();
+    if (bEnable) {
+        pTextIdx.reset(new LTAPITextIndex());
+        for (MapLTAPIAircraftNum::value_type& p: mapAcNum)
+            pTextIdx->insert(p.second.get());
+    }
+}
+
+// Finds an aircraft by exact call sign
+SPtrLTAPIAircraft LTAPIConnect::findByCallSign (const std::string& callSign) const
+{
+    return pTextIdx ? getSPtr(pTextIdx->find(LTAPITextIndex::TI_CALLSIGN, callSign)) : SPtrLTAPIAircraft();
+}
+
+// Finds an aircraft by exact registration
+SPtrLTAPIAircraft LTAPIConnect::findByRegistration (const std::string& registration) const
+{
+    return pTextIdx ? getSPtr(pTextIdx->find(LTAPITextIndex::TI_REG, registration)) : SPtrLTAPIAircraft();
+}
+
+// Finds an aircraft by exact flight number
+SPtrLTAPIAircraft LTAPIConnect::findByFlightNumber (const std::string& flightNumber) const
+{
+    return pTextIdx ? getSPtr(pTextIdx->find(LTAPITextIndex::TI_FLIGHTNO, flightNumber)) : SPtrLTAPIAircraft();
+}
+
+// Finds all aircraft by exact call sign
+size_t LTAPIConnect::findAllByCallSign (const std::string& callSign, VecLTAPIAircraft& outAc) const
+{
+    return FindAllByText(LTAPITextIndex::TI_CALLSIGN, callSign, outAc);
+}
+
+// Finds all aircraft by exact registration
+size_t LTAPIConnect::findAllByRegistration (const std::string& registration, VecLTAPIAircraft& outAc) const
+{
+    return FindAllByText(LTAPITextIndex::TI_REG, registration, outAc);
+}
+
+// Finds all aircraft by exact flight number
+size_t LTAPIConnect::findAllByFlightNumber (const std::string& flightNumber, VecLTAPIAircraft& outAc) const
+{
+    return FindAllByText(LTAPITextIndex::TI_FLIGHTNO, flightNumber, outAc);
+}
+
+// Finds all aircraft with the exact text in one field of the text indexes
+size_t LTAPIConnect::FindAllByText (int field, const std::string& s, VecLTAPIAircraft& outAc) const
+{
+    outAc.clear();
+    if (!pTextIdx)
+        return 0;
+    const auto range = pTextIdx->equal_range(LTAPITextIndex::FieldTy(field), s);
+    for (auto iter = range.first; iter != range.second; ++iter)
+        outAc.push_back(getSPtr(iter->second));
+    std::sort(outAc.begin(), outAc.end(),
+              [](const SPtrLTAPIAircraft& a, const SPtrLTAPIAircraft& b)
+              { return a->getKeyNum() < b->getKeyNum(); });
+    return outAc.size();
+}
+
+// Enables publishing of immutable snapshots for other threads
+void LTAPIConnect::EnableSnapshots (bool bEnable)
+{
+    bSnapshots = bEnable;
+    if (!bEnable) {
+        std::atomic_store(&spSnapshot, SPtrLTAPISnapshot());
+        spSnapSpare.reset();
+    }
+}
+
+// Copies all aircraft data into a snapshot and publishes it
+void LTAPIConnect::PublishSnapshot ()
+{
+    // Reuse the spare snapshot if there is one, so that its vectors don't need to allocate
+    std::shared_ptr<LTAPISnapshot> spSnap = std::move(spSnapSpare);
+    if (!spSnap)
+        spSnap = std::make_shared<LTAPISnapshot>();
+    spSnap->seq = ++snapSeq;
+    spSnap->ts  = std::chrono::steady_clock::now();
+    // Sorted by key, so that readers can binary-search
+    vSnapOrder.clear();
+    for (const MapLTAPIAircraftNum::value_type& p: mapAcNum)
+        vSnapOrder.emplace_back(p.first, p.second.get());
+    std::sort(vSnapOrder.begin(), vSnapOrder.end(),
+              [](const std::pair<uint64_t,const LTAPIAircraft*>& a,
+                 const std::pair<uint64_t,const LTAPIAircraft*>& b)
+              { return a.first < b.first; });
+    spSnap->vBulk.clear();
+    spSnap->vInfo.clear();
+    spSnap->vBulk.reserve(vSnapOrder.size());
+    spSnap->vInfo.reserve(vSnapOrder.size());
+    for (const std::pair<uint64_t,const LTAPIAircraft*>& p: vSnapOrder) {
+        spSnap->vBulk.push_back(p.second->bulk);
+        spSnap->vInfo.push_back(p.second->info);
+    }
+    
+    // Publish, and take back the previous snapshot:
+    // If we hold the only reference then no reader uses it any longer,
+    // and as it is no longer published no reader can acquire it anymore,
+    // so we can reuse it next time.
+    SPtrLTAPISnapshot spPrev = std::atomic_exchange(&spSnapshot, SPtrLTAPISnapshot(std::move(spSnap)));
+    if (spPrev && spPrev.use_count() == 1) {
+        // use_count() is only a relaxed load. The last reader released its
+        // reference with a release decrement, so this acquire fence orders
+        // all its reads of the snapshot before our refilling it next time.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        spSnapSpare = std::const_pointer_cast<LTAPISnapshot>(std::move(spPrev));
+    }
+}
+
+// Enables reporting of added, updated, and removed aircraft
+void LTAPIConnect::EnableEvents (bool bEnable)
+{
+    bEvents = bEnable;
+    if (!bEnable)
+        vEvents.clear();
+}
+
+// Registers an event callback
+void LTAPIConnect::RegisterEventCB (fAcEventCB* pfCB, void* refcon)
+{
+    if (!pfCB)
+        return;
+    const std::pair<fAcEventCB*,void*> cb(pfCB, refcon);
+    if (std::find(vEventCB.begin(), vEventCB.end(), cb) == vEventCB.end())
+        vEventCB.push_back(cb);
+    bEvents = true;
+}
+
+// Unregisters an event callback
+void LTAPIConnect::UnregisterEventCB (fAcEventCB* pfCB, void* refcon)
+{
+    vEventCB.erase(std::remove(vEventCB.begin(), vEventCB.end(),
+                               std::pair<fAcEventCB*,void*>(pfCB, refcon)),
+                   vEventCB.end());
+}
+
+// Adds an event unless the aircraft has already been reported during this call
+void LTAPIConnect::AddEvent (LTAPIAircraft* pAc, LTAPIAcEvent::EventTy ev)
+{
+    // Removal is always reported, even if the aircraft changed before
+    if (pAc->evCycle == evCycle && ev != LTAPIAcEvent::EV_REMOVED)
+        return;
+    pAc->evCycle = evCycle;
+    LTAPIAcEvent e;
+    e.keyNum = pAc->keyNum;
+    e.ev = ev;
+    vEvents.push_back(e);
+}
+
+// Calls the registered event callbacks
+void LTAPIConnect::NotifyEvents ()
+{
+    if (vEvents.empty())
+        return;
+    // index-based, so that callbacks can unregister themselves
+    for (size_t i = 0; i < vEventCB.size(); i++)
+        vEventCB[i].first(*this, vEvents, vEventCB[i].second);
+}
+
+// Enables fetching numeric data by level-of-detail tiers
+void LTAPIConnect::EnableLOD (bool bEnable,
+                              const std::vector<LODTier>& tiers,
+                              unsigned fullIntvl)
+{
+    bLOD = bEnable;
+    lodCall = 0;
+    if (tiers.empty())
+        vLODTiers = { {25.0f, 1}, {75.0f, 2}, {150.0f, 4} };
+    else
+        vLODTiers = tiers;
+    // sorted by distance, no interval less than 1
+    std::sort(vLODTiers.begin(), vLODTiers.end(),
+              [](const LODTier& a, const LODTier& b){ return a.maxDist_nm < b.maxDist_nm; });
+    for (LODTier& t: vLODTiers)
+        t.intvl = std::max(t.intvl, 1u);
+    lodFullIntvl = std::max(fullIntvl, 1u);
+}
+
+// Determines the ranges of offsets due in this level-of-detail call
+void LTAPIConnect::PlanLODRanges (int numAc)
+{
+    // Offsets in blocks of this size share their phase when staggering,
+    // so that due aircraft form ranges rather than single offsets
+    constexpr int LOD_BLOCK = 16;
+    // Fetching a few aircraft not due is cheaper than another round trip
+    constexpr int LOD_MAX_GAP = 4;
+    
+    vLODRanges.clear();
+    const int n = std::min(numAc, int(vHint.size()));
+    for (int i = 0; i < n; i++) {
+        const LTAPIAircraft* pAc = vHint[size_t(i)];
+        // An offset without known aircraft is always due, could be a new aircraft
+        bool bDue = !pAc;
+        if (pAc)
+            for (const LODTier& t: vLODTiers)
+                if (pAc->bulk.dist_nm < t.maxDist_nm) {
+                    bDue = (lodCall + unsigned(i / LOD_BLOCK)) % t.intvl == 0;
+                    break;
+                }
+        if (!bDue)
+            continue;
+        if (!vLODRanges.empty() && i - vLODRanges.back().second <= LOD_MAX_GAP)
+            vLODRanges.back().second = i + 1;
+        else
+            vLODRanges.emplace_back(i, i + 1);
+    }
+}
+
+// Determines the ranges of offsets for this call's sliced expensive fetch
+void LTAPIConnect::PlanExpsvSlice (int numAc, bool bSlice)
+{
+    vExpsvRanges.clear();
+    
+    // Offsets of new aircraft, merged into consecutive ranges
+    std::sort(vNewAcIdx.begin(), vNewAcIdx.end());
+    for (int idx: vNewAcIdx) {
+        if (!vExpsvRanges.empty() && vExpsvRanges.back().second >= idx)
+            vExpsvRanges.back().second = std::max(vExpsvRanges.back().second, idx + 1);
+        else
+            vExpsvRanges.emplace_back(idx, idx + 1);
+    }
+    
+    if (!bSlice)
+        return;
+    
+    // Share of all aircraft due by now so that all are refreshed once per sPeriodExpsv
+    const std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
+    if (sPeriodExpsv.count() <= 0)
+        expsvQuota = double(numAc);
+    else if (lastExpsvFetch != std::chrono::time_point<std::chrono::steady_clock>())
+        expsvQuota = std::min(expsvQuota +
+                              double(numAc) * std::chrono::duration<double>(now - lastExpsvFetch).count() /
+                              std::chrono::duration<double>(sPeriodExpsv).count(),
+                              double(numAc));
+    lastExpsvFetch = now;
+    const int num = int(expsvQuota);
+    expsvQuota -= num;
+    if (num <= 0)
+        return;
+    
+    // The next `num` aircraft, round-robin
+    if (expsvAc >= numAc)
+        expsvAc = 0;
+    const int acEnd = expsvAc + num;
+    vExpsvRanges.emplace_back(expsvAc, std::min(acEnd, numAc));
+    if (acEnd > numAc)
+        vExpsvRanges.emplace_back(0, acEnd - numAc);
+    expsvAc = acEnd % numAc;
+    
+    // The slice can overlap new aircraft: sort and merge again, so that no aircraft is fetched twice
+    std::sort(vExpsvRanges.begin(), vExpsvRanges.end());
+    size_t n = 0;
+    for (size_t i = 0; i < vExpsvRanges.size(); i++) {
+        if (n > 0 && vExpsvRanges[n-1].second >= vExpsvRanges[i].first)
+            vExpsvRanges[n-1].second = std::max(vExpsvRanges[n-1].second, vExpsvRanges[i].second);
+        else
+            vExpsvRanges[n++] = vExpsvRanges[i];
+    }
+    vExpsvRanges.resize(n);
+}
+
+// Index of aircraft with given key
+long LTAPISnapshot::find (uint64_t keyNum) const
+{
+    const auto iter = std::lower_bound(vBulk.begin(), vBulk.end(), keyNum,
+                                       [](const LTAPIAircraft::LTAPIBulkData& b, uint64_t k)
+                                       { return b.keyNum < k; });
+    return iter != vBulk.end() && iter->keyNum == keyNum ? long(iter - vBulk.begin()) : -1;
+}
+
+// Registers own read-only dataRefs publishing performance metrics
+bool LTAPIConnect::PublishStatsDataRefs (const std::string& pluginName)
+{
+    if (pluginName.empty())
+        return false;
+    pStatsDR.reset();                   // unregisters previous dataRefs first
+    pStatsDR.reset(new LTAPIStatsDataRefs(pluginName));
+    return true;
+}
+
+// Unregisters the dataRefs registered by PublishStatsDataRefs()
+void LTAPIConnect::UnpublishStatsDataRefs ()
+{
+    pStatsDR.reset();
+}
+
+// Adds up another set of values
+void LTAPIConnect::UpdateStats::add (const UpdateStats& o)
+{
+    nsTotal     += o.nsTotal;
+    nsQuick     += o.nsQuick;
+    nsExpsv     += o.nsExpsv;
+    numGetData  += o.numGetData;
+    bytesQuick  += o.bytesQuick;
+    bytesExpsv  += o.bytesExpsv;
+    numCreated  += o.numCreated;
+    numUpdated  += o.numUpdated;
+    numRemoved  += o.numRemoved;
+    numExpsv    += o.numExpsv;
+}
+
+// Log2 histogram bucket for a latency
+static unsigned LatBucket (uint32_t ns)
+{
+    unsigned b = 0;
+    while (ns >>= 1)
+        b++;
+    return b;
+}
+
+// Adds one call's values, called at the end of UpdateAcList()
+void LTAPIConnect::Stats::addCall (const UpdateStats& call)
+{
+    last = call;
+    total.add(call);
+    
+    // rolling latency window: the new value replaces the oldest one
+    const uint32_t ns = uint32_t(std::min<uint64_t>(call.nsTotal, UINT32_MAX));
+    uint32_t& slot = latRing[numCalls % LAT_WINDOW];
+    if (numCalls >= LAT_WINDOW)
+        latHist[LatBucket(slot)]--;
+    slot = ns;
+    latHist[LatBucket(ns)]++;
+    numCalls++;
+}
+
+// Latency percentile over the rolling window
+uint32_t LTAPIConnect::Stats::getLatPercentile (double p) const
+{
+    const unsigned n = getLatCount();
+    if (!n) return 0;
+    uint32_t v[LAT_WINDOW];
+    std::copy(latRing, latRing + n, v);
+    const unsigned k = std::min(n - 1, unsigned(p * double(n)));
+    std::nth_element(v, v + k, v + n);
+    return v[k];
+}
+
+// Finalizes the current call's statistics
+void LTAPIConnect::StatsFinishCall (std::chrono::steady_clock::time_point LTAPI_STATS_DO(tStart))
+{
+    LTAPI_STATS_DO(statsCall.nsTotal = nsSince(tStart));
+    LTAPI_STATS_DO(stats.addCall(statsCall));
+}
+
+
+// LTAPIConnect::Clear camera information, ie. delcare that no aircraft is currently being viewed
+void clearCameraInfo ()
+{
+    LTAPI::setCameraAcDataRefs(0, 0);
+}
+
+
+// fetch bulk data and create/update aircraft objects
 template <class T>
 bool LTAPIConnect::DoBulkFetch (int numAc, LTDataRef& DR, int& outSizeLT,
-                                std::unique_ptr<T[]> &vBulk)
+                                std::unique_ptr<T[]> &vBulk, int& ioAc,
+                                std::chrono::time_point<std::chrono::steady_clock> tDeadline,
+                                const VecAcRange* pRanges)
 {
     // later return value: Did we add any new objects?
     bool ret = false;
+    // Only the numeric data call is allowed to create new objects
+    constexpr bool bCreateNew = std::is_same<T, LTAPIAircraft::LTAPIBulkData>::value;
     
     // Size negotiation first (we need to do that before _every_ call
     // because in theory there could be another plugin using a different
@@ -530,43 +2520,296 @@ bool LTAPIConnect::DoBulkFetch (int numAc, LTDataRef& DR, int& outSizeLT,
     // size _can_ differ at all and we need to cater for LTAPI being
     // bigger than what LT fills. Not yet possible as this is the
     // initial version on both sides. So we don't yet use the result.
-    outSizeLT = DR.getData(NULL, 0, sizeof(T));
+    // Statistics of the current call: time, bytes, and round trips of this fetch
+    LTAPI_STATS_DO(uint64_t& nsFetch = bCreateNew ? statsCall.nsQuick : statsCall.nsExpsv);
+    LTAPI_STATS_DO(uint64_t& bytesFetch = bCreateNew ? statsCall.bytesQuick : statsCall.bytesExpsv);
+    LTAPI_STATS_DO(std::chrono::steady_clock::time_point tGet = std::chrono::steady_clock::now());
     
-    // outer loop: get bulk data (iBulkAc number of a/c per request) from LT
-    for (int ac = 0;
-         ac < numAc;
-         ac += iBulkAc)
+    if (!pReplay) {
+        outSizeLT = DR.getData(NULL, 0, sizeof(T));
+        LTAPI_STATS_DO(nsFetch += nsSince(tGet));
+        LTAPI_STATS_DO(statsCall.numGetData++);
+    }
+    
+    // The numeric fetch rebuilds multiplayer slot table and camera aircraft aside,
+    // they replace the current ones only once the sweep is complete, see DoUpdateAcList().
+    // (When starting a sweep; a resumed sweep continues, a fetch of selected ranges updates the current ones.)
+    bool bSlotsNext = bCreateNew && !pRanges;
+    if (bCreateNew && ioAc == 0 && !pRanges) {
+        std::fill(std::begin(aMultiIdxAcNext), std::end(aMultiIdxAcNext), nullptr);
+        pCameraAcNext = nullptr;
+    }
+    // Registers an aircraft updated by the numeric fetch in slot table and as camera aircraft
+    auto IndexSlots = [this,&bSlotsNext](LTAPIAircraft* pAc)
+    {
+        const int multiIdx = pAc->bulk.bits.multiIdx;
+        if (multiIdx >= 1 && multiIdx < MAX_MULTI_IDX)
+            (bSlotsNext ? aMultiIdxAcNext : aMultiIdxAc)[multiIdx] = pAc;
+        if (pAc->bulk.bits.camera)
+            (bSlotsNext ? pCameraAcNext : pCameraAc) = pAc;
+    };
+    
+    // The numeric fetch sees all aircraft and builds up the hint cache for next time,
+    // the expensive fetch only makes use of it.
+    // A numeric fetch of selected ranges updates the current hint cache in place.
+    std::vector<LTAPIAircraft*>* pHintOut = bCreateNew && !pRanges ? &vHintNext : &vHint;
+    int nextOldIdx = -1;            // offset last time of the aircraft that followed the previous one
+    
+    // Copies received data into the aircraft objects
+    auto ProcessBulk = [&](const T* pRcvd, const int ac, const int acRcvd,
+                           const std::chrono::time_point<std::chrono::steady_clock> tsFetch)
     {
-        // get a bulk of data from LiveTraffic
-        // (std::min(...iBulkAc) makes sure we don't exceed our array)
-        const int acRcvd = std::min (DR.getData(vBulk.get(),
-                                                ac * sizeof(T),
-                                                iBulkAc * sizeof(T)) / int(sizeof(T)),
-                                     iBulkAc);
-        
-        // inner loop: copy the received data into the aircraft objects
         for (int i = 0; i < acRcvd; i++)
         {
-            const T& bulk = vBulk[i];
+            const T& bulk = pRcvd[i];
+            const int idx = ac + i;
+            
+            // Same aircraft at this offset as last time,
+            // or the one that followed the previous aircraft last time?
+            // Then we don't need to search the map.
+            LTAPIAircraft* pAc = vHint[size_t(idx)];
+            if (!pAc || pAc->keyNum != bulk.keyNum) {
+                pAc = nextOldIdx >= 0 && size_t(nextOldIdx) < vHint.size() ? vHint[size_t(nextOldIdx)] : nullptr;
+                if (pAc && pAc->keyNum != bulk.keyNum)
+                    pAc = nullptr;
+            }
             
-            // try to find the matching aircraft object in out map
-            const std::string key = LTAPI::hexStr(bulk.keyNum);
-            MapLTAPIAircraft::iterator iter = mapAc.find(key);
-            if (iter == mapAc.end())            // didn't find, need new one
+            if (pAc) {
+                ++numHintHits;
+            }
+            else
             {
-                // create a new aircraft object
-                assert(pfCreateAcObject);
-                iter = mapAc.emplace(key, pfCreateAcObject()).first;
-                // tell caller we added new objects
-                ret = true;
+                ++numHintMisses;
+                // try to find the matching aircraft object in our map
+                MapLTAPIAircraftNum::iterator iter = mapAcNum.find(bulk.keyNum);
+                if (iter == mapAcNum.end())         // didn't find, need new one
+                {
+                    // Only numeric data creates new objects. Texts for an aircraft
+                    // we don't know yet (LT added it between the two calls)
+                    // will be fetched with the next expensive call anyway.
+                    if (!bCreateNew)
+                        continue;
+                    
+                    // create a new aircraft object
+                    iter = mapAcNum.emplace(bulk.keyNum, CreateAc()).first;
+                    pAc = iter->second.get();
+                    pAc->updateAircraft(bulk, outSizeLT);
+                    pAc->tsBulk = tsFetch;
+                    LTAPI_STATS_DO(statsCall.numCreated++);
+                    if (bEvents)
+                        AddEvent(pAc, LTAPIAcEvent::EV_ADDED);
+                    if (bSliceExpsv)
+                        vNewAcIdx.push_back(idx);
+                    if (bCols)
+                        cols.push_back(pAc);
+                    if (bGrid)
+                        grid.insert(pAc);
+                    IndexSlots(pAc);
+                    // add to the string map, too, if we maintain it
+                    if (bMapStr)
+                        mapAc.emplace(pAc->getKey(), iter->second);
+                    // tell caller we added new objects
+                    ret = true;
+                    // remember in the hint cache
+                    nextOldIdx = -1;
+                    pAc->iBulkIdx = idx;
+                    (*pHintOut)[size_t(idx)] = pAc;
+                    continue;
+                }
+                pAc = iter->second.get();
+            }
+            
+            // Next aircraft is likely the one that followed this one last time
+            nextOldIdx = pAc->iBulkIdx >= 0 ? pAc->iBulkIdx + 1 : -1;
+            if (bCreateNew) {
+                pAc->iBulkIdx = idx;
+                (*pHintOut)[size_t(idx)] = pAc;
             }
             
-            // copy the bulk data
-            assert(iter != mapAc.end());
-            iter->second->updateAircraft(bulk, outSizeLT);
-        } // inner loop processing received bulk data
+            // Has the received numeric data changed? (Only of interest if not yet reported)
+            // Compares only the bytes LT sent, which updateAircraft() stores unchanged,
+            // not the fields it fills for older versions of LT.
+            // (Texts report changes themselves, see LTAPIAircraft::haveTextsChanged())
+            const bool bChanged = bCreateNew && bEvents && pAc->evCycle != evCycle &&
+                std::memcmp(&pAc->bulk, &bulk,
+                            std::min(size_t(std::max(outSizeLT, 0)), sizeof(LTAPIAircraft::LTAPIBulkData))) != 0;
+            
+            // copy the bulk data, re-index texts if they changed
+            // (only then hash the current texts, which rarely is the case)
+            LTAPITextIndex::KeysTy oldKeys;
+            const bool bReindex = pTextIdx && LTAPITextIndex::MayChangeKeys(*pAc, bulk);
+            if (bReindex)
+                LTAPITextIndex::GetKeys(*pAc, oldKeys);
+            if constexpr (!bCreateNew)
+                pAc->CheckTexts(bulk, size_t(outSizeLT));
+            pAc->updateAircraft(bulk, outSizeLT);
+            if (!bCreateNew && pAc->haveTextsChanged())
+                pAc->textsChanged();
+            if (bCreateNew)
+                pAc->tsBulk = tsFetch;
+            if (bChanged)
+                AddEvent(pAc, LTAPIAcEvent::EV_UPDATED);
+            if (!bCreateNew && pAc->haveTextsChanged()) {
+                if (bEvents && pAc->evCycle != evCycle)
+                    AddEvent(pAc, LTAPIAcEvent::EV_UPDATED);
+                if (bReindex)
+                    pTextIdx->update(pAc, oldKeys);
+            }
+            if (bCreateNew) {
+                if (bCols)
+                    cols.set(size_t(pAc->iCol));
+                if (bGrid)
+                    grid.update(pAc);
+                IndexSlots(pAc);
+            }
+            LTAPI_STATS_DO(if (bCreateNew) statsCall.numUpdated++);
+        }
+    };
+    
+    // Gets `num` aircraft starting at offset `ac` from LT and copies them into the aircraft objects
+    auto FetchBulk = [&](const int ac, const int num) -> int
+    {
+        // get a bulk of data from LiveTraffic
+        // (num <= iBulkAc makes sure we don't exceed our array)
+        LTAPI_STATS_DO(tGet = std::chrono::steady_clock::now());
+        const int bytesRcvd = DR.getData(vBulk.get(),
+                                         ac * sizeof(T),
+                                         num * sizeof(T));
+        LTAPI_STATS_DO(nsFetch += nsSince(tGet));
+        LTAPI_STATS_DO(statsCall.numGetData++);
+        LTAPI_STATS_DO(if (bytesRcvd > 0) bytesFetch += uint64_t(bytesRcvd));
+        const int acRcvd = std::min (bytesRcvd / int(sizeof(T)), num);
+        
+        // record the raw data if requested
+        if (fCapture && acRcvd > 0)
+            WriteCaptureRec(bCreateNew ? LTAPIReplay::REC_QUICK : LTAPIReplay::REC_EXPSV,
+                            outSizeLT, ac, vBulk.get(), acRcvd * int(sizeof(T)));
+        
+        // copy the received data into the aircraft objects
+        ProcessBulk(vBulk.get(), ac, acRcvd, std::chrono::steady_clock::now());
+        return acRcvd;
+    };
+    
+    // outer loop: get bulk data (iBulkAc number of a/c per request) from LT
+    int ac = ioAc;
+    ioAc = 0;
+    
+    // Resuming the numeric fetch of a sweep: LT might have added or removed aircraft
+    // since the last call, so that aircraft we haven't seen yet moved in front of our offset.
+    // LT keeps its aircraft in a stable order, so we resume right after an aircraft
+    // we have already updated during this sweep, probing further back until we find one.
+    if (bCreateNew && ac > 0 && !pRanges && !pReplay) {
+        int step = 1;
+        for (ac = std::min(ac, numAc) - 1; ac > 0; ac = std::max(ac - step, 0), step *= 2) {
+            LTAPI_STATS_DO(tGet = std::chrono::steady_clock::now());
+            const int bytesRcvd = DR.getData(vBulk.get(), ac * sizeof(T), sizeof(T));
+            LTAPI_STATS_DO(nsFetch += nsSince(tGet));
+            LTAPI_STATS_DO(statsCall.numGetData++);
+            LTAPI_STATS_DO(if (bytesRcvd > 0) bytesFetch += uint64_t(bytesRcvd));
+            if (bytesRcvd >= int(sizeof(T))) {
+                MapLTAPIAircraftNum::const_iterator iter = mapAcNum.find(vBulk[0].keyNum);
+                if (iter != mapAcNum.end() && iter->second->isUpdated()) {
+                    ac++;                       // resume with the aircraft following it
+                    break;
+                }
+            }
+        }
+    }
+    if (pReplay) {
+        // Replay: process recorded chunks, which point directly into the mapped capture
+        for (const LTAPIReplay::RecHdr* pRec = pReplay->NextBulk(bCreateNew);
+             pRec;
+             pRec = pReplay->NextBulk(bCreateNew))
+        {
+            outSizeLT = pRec->sizeLT;
+            const int acFirst = std::max(ac, std::min(int(pRec->offset), int(vHint.size())));
+            const int acRcvd = std::min(int(pRec->numBytes) / int(sizeof(T)), int(vHint.size()) - acFirst);
+            // clear hints of offsets not covered by the capture
+            if (bCreateNew)
+                std::fill(pHintOut->begin() + ac, pHintOut->begin() + acFirst, nullptr);
+            ProcessBulk(reinterpret_cast<const T*>(pRec + 1), acFirst, acRcvd,
+                        std::chrono::steady_clock::now());
+            LTAPI_STATS_DO(bytesFetch += uint64_t(pRec->numBytes));
+            ac = acFirst + acRcvd;
+        }
+    }
+    else if (pRanges) {
+        // Fetch only the requested ranges, in bulks
+        const uint64_t numMissesBefore = numHintMisses;
+        for (VecAcRange::const_iterator iterR = pRanges->begin(); iterR != pRanges->end(); ++iterR)
+            for (ac = iterR->first; ac < iterR->second; ac += iBulkAc)
+            {
+                FetchBulk(ac, std::min(iBulkAc, iterR->second - ac));
+                
+                // Numeric aircraft not at their previous offsets? Then LT's list has changed.
+                // Continue as a full fetch, which doesn't fetch again what we already have:
+                // Up to here offsets were unchanged, so we take their hints over
+                // and only fetch the offsets not yet fetched.
+                if (!bCreateNew || numHintMisses == numMissesBefore)
+                    continue;
+                const int acDone = std::min(ac + iBulkAc, iterR->second);
+                pHintOut = &vHintNext;
+                bSlotsNext = true;
+                std::fill(std::begin(aMultiIdxAcNext), std::end(aMultiIdxAcNext), nullptr);
+                pCameraAcNext = nullptr;
+                // Takes over hints of fetched offsets `[from, to)`
+                auto KeepFetched = [&](const int from, const int to)
+                {
+                    for (int i = from; i < to; i++)
+                        if ((vHintNext[size_t(i)] = vHint[size_t(i)]) != nullptr)
+                            IndexSlots(vHint[size_t(i)]);
+                };
+                // Fetches offsets `[from, to)` not fetched before
+                auto FetchGap = [&](const int from, const int to)
+                {
+                    for (int a = from; a < to; a += iBulkAc) {
+                        const int num = std::min(iBulkAc, to - a);
+                        const int acRcvd = FetchBulk(a, num);
+                        std::fill(vHintNext.begin() + a + std::max(acRcvd, 0), vHintNext.begin() + a + num, nullptr);
+                    }
+                };
+                int acFrom = 0;
+                for (VecAcRange::const_iterator iterDone = pRanges->begin(); iterDone != iterR; ++iterDone) {
+                    FetchGap(acFrom, iterDone->first);
+                    KeepFetched(iterDone->first, iterDone->second);
+                    acFrom = iterDone->second;
+                }
+                FetchGap(acFrom, iterR->first);
+                KeepFetched(iterR->first, acDone);
+                FetchGap(acDone, numAc);
+                
+                // Now the new hint cache becomes the current one
+                std::fill(vHintNext.begin() + numAc, vHintNext.end(), nullptr);
+                vHint.swap(vHintNext);
+                return ret;
+            }
+    }
+    else for (;
+         ac < numAc;
+         ac += iBulkAc)
+    {
+        // get a bulk of data from LiveTraffic and copy it into the aircraft objects
+        const int acRcvd = FetchBulk(ac, iBulkAc);
+        
+        // LT returned less than requested? Clear the hints we didn't fill
+        if (bCreateNew)
+            std::fill(pHintOut->begin() + ac + std::max(acRcvd, 0), pHintOut->begin() + ac + iBulkAc, nullptr);
+        
+        // Time budget used up? Then the next call resumes with the next bulk
+        if (ac + iBulkAc < numAc && std::chrono::steady_clock::now() >= tDeadline) {
+            ioAc = ac + iBulkAc;
+            return ret;
+        }
     } // outer loop fetching bulk data from LT
     
+    // After the numeric fetch the new hint cache becomes the current one,
+    // with no references left beyond what we have filled
+    if (bCreateNew && !pRanges) {
+        if (size_t(ac) < vHintNext.size())
+            std::fill(vHintNext.begin() + ac, vHintNext.end(), nullptr);
+        vHint.swap(vHintNext);
+    }
+    
     return ret;
 }
 
@@ -585,10 +2828,8 @@ void LTAPIConnect::CameraSharedDataCB (LTAPIConnect* me)
     
     // search the map for a matching aircraft that is _now_ under the camera
     if (modeS_id) {
-        char keyHex[10];
-        snprintf ( keyHex, sizeof(keyHex), "%06X", (unsigned int)modeS_id );
-        MapLTAPIAircraft::iterator iter = me->mapAc.find(keyHex);
-        if (iter != me->mapAc.end())
+        MapLTAPIAircraftNum::iterator iter = me->mapAcNum.find(uint64_t((unsigned int)modeS_id));
+        if (iter != me->mapAcNum.end())
             spCamAc = iter->second;
     }
 
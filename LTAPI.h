@@ -30,18 +30,28 @@
 #ifndef LTAPI_h
 #define LTAPI_h
 
+#include <cstddef>
+#include <cstdio>
 #include <cstring>
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <list>
+#include <vector>
 #include <map>
+#include <unordered_map>
 #include <chrono>
+#include <mutex>
 
 #include "XPLMDataAccess.h"
 #include "XPLMGraphics.h"
 
 class LTDataRef;
 class LTAPIAircraft;
+class LTAPIReplay;
+class LTAPIStatsDataRefs;
+class LTAPITextIndex;
 
 /// Smart pointer to an LTAPIAircraft object
 typedef std::shared_ptr<LTAPIAircraft> SPtrLTAPIAircraft;
@@ -54,12 +64,34 @@ typedef std::shared_ptr<LTAPIAircraft> SPtrLTAPIAircraft;
 /// create new aircraft objects when required by LTAPIConnect.
 class LTAPIAircraft
 {
+    friend class LTAPIConnect;
+    friend struct LTAPIAcColumns;
+    friend class LTAPIGridIndex;
+    friend class LTAPITextIndex;
 private:
     /// @brief Unique key for this aircraft, usually ICAO transponder hex code
     /// But could also be any other truly unique id per aircraft (FLARM ID, tail number...)
-    unsigned        keyNum = 0;
-    /// Key converted to a hex string
-    std::string     key;
+    uint64_t        keyNum = 0;
+    /// Has `keyNum` been set already by the first call to updateAircraft()?
+    bool            bHasKey = false;
+    /// Key converted to a hex string, computed lazily by getKey() only
+    mutable std::string key;
+    /// Cached result of getDescription(), valid if `bDescr`
+    mutable std::string descr;
+    /// Is `descr` up to date? Reset when a contributing field changes
+    mutable bool    bDescr = false;
+    /// Offset in LiveTraffic's bulk data at which this aircraft was last seen, maintained by LTAPIConnect
+    int             iBulkIdx = -1;
+    /// Row in LTAPIConnect's column view, `-1` if not maintained
+    int             iCol = -1;
+    /// Cell in LTAPIConnect's grid index
+    uint64_t        gridCell = 0;
+    /// Position in that cell's list, `-1` if not in the grid index
+    int             gridPos = -1;
+    /// UpdateAcList() call, which last reported an event for this aircraft
+    uint64_t        evCycle = 0;
+    /// When `bulk` was fetched, maintained by LTAPIConnect
+    std::chrono::time_point<std::chrono::steady_clock> tsBulk;
 
 public:
     
@@ -193,6 +225,21 @@ protected:
     
     /// update helper, gets reset before updates, set during updates, stays false if not updated
     bool            bUpdated = false;
+    /// Did the texts differ from the stored ones in the latest text update? Set by CheckTexts()
+    bool            bTextsChanged = false;
+    
+    /// @brief Compares received texts with the stored ones, sets `bTextsChanged` and invalidates the description
+    /// @details Called by LTAPIConnect before updateAircraft(const LTAPIBulkInfoTexts&, size_t),
+    ///          so that the flag is right also if an override doesn't call the base version.
+    void CheckTexts (const LTAPIBulkInfoTexts& __info, size_t __inSize);
+    
+    /// View of a zero-terminated text field, never reading beyond the array
+    template<size_t N>
+    static std::string_view View (const char (&s)[N])
+    {
+        const void* pEnd = std::memchr(s, 0, N);
+        return std::string_view(s, pEnd ? size_t(static_cast<const char*>(pEnd) - s) : N);
+    }
     
 public:
     LTAPIAircraft();
@@ -211,10 +258,18 @@ public:
     /// @param __info A structure with updated textual info
     /// @param __inSize Number of bytes returned by LiveTraffic
     virtual bool updateAircraft(const LTAPIBulkInfoTexts& __info, size_t __inSize);
-    /// Helper in update loop to detected removed aircrafts
+    /// @brief Has the numeric data been fetched during the current sweep?
+    /// @details Helper in update loop to detect removed aircraft. Only numeric data sets it,
+    ///          so in level-of-detail calls it tells which aircraft were fetched.
     bool isUpdated () const { return bUpdated; }
     /// Helper in update loop, resets `bUpdated` flag
     void resetUpdated ()    { bUpdated = false; }
+    /// Did the latest text update actually change any text?
+    bool haveTextsChanged () const { return bTextsChanged; }
+    
+    /// @brief Called after updateAircraft(const LTAPIBulkInfoTexts&, size_t) only if texts actually changed,
+    ///        override in your class to derive data from the texts instead of overriding updateAircraft()
+    virtual void textsChanged () {}
     
     /// @brief Called when LiveTraffic toggles its aircraft camera, override in your class to handle event
     /// @param bCameraActive `True` if camera is on this aircraft now, `false` if camera is switched off
@@ -227,7 +282,8 @@ public:
     
     // data access
 public:
-    std::string     getKey()            const { return key; }                   ///< Unique key for this aircraft, usually ICAO transponder hex code
+    std::string     getKey()            const;                                  ///< Unique key for this aircraft, usually ICAO transponder hex code
+    uint64_t        getKeyNum()         const { return keyNum; }                ///< Unique key for this aircraft as number, no string conversion needed
     // identification
     std::string     getRegistration()   const { return info.registration; }     ///< tail number like "D-AISD"
     // aircraft model/operator
@@ -247,8 +303,36 @@ public:
     std::string     getOrigin()         const { return info.origin; }           ///< origin airport (IATA or ICAO) like "MAD" or "LEMD"
     std::string     getDestination()    const { return info.destination; }      ///< destination airport (IATA or ICAO) like "FRA" or "EDDF"
     std::string     getTrackedBy()      const { return info.trackedBy; }        ///< name of channel deliverying the underlying tracking data
+    // zero-copy views of the same texts, valid until the aircraft's texts are next updated
+    std::string_view getRegistrationView()  const { return View(info.registration); }  ///< tail number like "D-AISD"
+    std::string_view getModelIcaoView()     const { return View(info.modelIcao); }     ///< ICAO aircraft type like "A321"
+    std::string_view getAcClassView()       const { return View(info.acClass); }       ///< a/c class like "L2J"
+    std::string_view getWtcView()           const { return View(info.wtc); }           ///< wake turbulence category like H,M,L/M,L
+    std::string_view getOpIcaoView()        const { return View(info.opIcao); }        ///< ICAO-code of operator like "DLH"
+    std::string_view getManView()           const { return View(info.man); }           ///< human-readable manufacturer like "Airbus"
+    std::string_view getModelView()         const { return View(info.model); }         ///< human-readable a/c model like "A321-231"
+    std::string_view getCatDescrView()      const { return View(info.catDescr); }      ///< human-readable category description
+    std::string_view getOpView()            const { return View(info.op); }            ///< human-readable operator like "Lufthansa"
+    std::string_view getCslModelView()      const { return View(info.cslModel); }      ///< name of CSL model used for actual rendering of plane
+    std::string_view getCallSignView()      const { return View(info.callSign); }      ///< call sign like "DLH56C"
+    std::string_view getSquawkView()        const { return View(info.squawk); }        ///< squawk code (as text) like "1000"
+    std::string_view getFlightNumberView()  const { return View(info.flightNumber); }  ///< flight number like "LH1113"
+    std::string_view getOriginView()        const { return View(info.origin); }        ///< origin airport (IATA or ICAO) like "MAD" or "LEMD"
+    std::string_view getDestinationView()   const { return View(info.destination); }   ///< destination airport (IATA or ICAO) like "FRA" or "EDDF"
+    std::string_view getTrackedByView()     const { return View(info.trackedBy); }     ///< name of channel deliverying the underlying tracking data
     // combined info
-    std::string     getDescription()    const;                                  ///< some reasonable descriptive string formed from the above, like an identifier, type, form/to
+    /// @brief Some reasonable descriptive string formed from the above, like an identifier, type, form/to
+    /// @note Cached until a contributing text changes. The cache is not synchronized:
+    ///       Call only from the thread that calls LTAPIConnect::UpdateAcList(),
+    ///       other threads use the buffer variant below.
+    std::string     getDescription()    const;
+    /// @brief Formats the description like getDescription() into a caller-supplied buffer, without allocation
+    /// @details Doesn't touch the cache, so it is the fast path also for other threads,
+    ///          as long as the aircraft isn't updated concurrently.
+    /// @param buf Output buffer, always zero-terminated if `bufSize > 0`, truncated if too small
+    /// @param bufSize Size of `buf` in bytes
+    /// @return Length of the full description, not counting the terminating zero, like `snprintf`
+    size_t          getDescription(char* buf, size_t bufSize) const;
     // position, attitude
     double          getLat()            const { return bulk.lat; }              ///< [°] latitude
     double          getLon()            const { return bulk.lon; }              ///< [°] longitude
@@ -275,6 +359,7 @@ public:
     float           getBearing()        const { return bulk.bearing; }          ///< [°] to current camera position
     float           getDistNm()         const { return bulk.dist_nm; }          ///< [nm] distance to current camera
     int             getMultiIdx()       const { return bulk.bits.multiIdx; }    ///< multiplayer index if plane reported via sim/multiplayer/position dataRefs, 0 if not
+    std::chrono::time_point<std::chrono::steady_clock> getBulkTime() const { return tsBulk; } ///< when numeric data was last fetched
 
     // calculated
     /// @brief `lat`/`lon`/`alt` converted to local coordinates
@@ -284,6 +369,19 @@ public:
     /// @param[out] z Local z coordinate
     void            getLocalCoord (double& x, double& y, double& z) const
     { XPLMWorldToLocal(bulk.lat,bulk.lon,bulk.alt_ft*0.3048, &x,&y,&z); }
+    
+    /// [s] Maximum time span extrapolate() extrapolates beyond the last fetch
+    static constexpr double MAX_EXTRAPOLATE_S = 10.0;
+    /// @brief Dead reckoning: position extrapolated from the last numeric data to the given time
+    /// @details Moves the aircraft along `track` with `speed_kt` and, unless on ground,
+    ///          climbs/descends with `vsi_ft`, starting at the time of the last fetch.
+    ///          Extrapolates no further than `MAX_EXTRAPOLATE_S`, and never backwards.
+    /// @param ts Point in time to extrapolate to, typically `std::chrono::steady_clock::now()`
+    /// @param[out] lat [°] latitude
+    /// @param[out] lon [°] longitude
+    /// @param[out] alt_ft [ft] altitude
+    void            extrapolate (std::chrono::time_point<std::chrono::steady_clock> ts,
+                                 double& lat, double& lon, double& alt_ft) const;
 
 public:
     /// @brief Standard object creation callback.
@@ -307,12 +405,379 @@ public:
 /// storage.
 typedef std::map<std::string,SPtrLTAPIAircraft> MapLTAPIAircraft;
 
+/// @brief Hash map of all aircrafts, keyed by the aircraft's numeric key
+///
+/// This is what LTAPIConnect::UpdateAcListNum() returns.
+/// The key is LTAPIAircraft::getKeyNum(), so no string conversion
+/// or string comparison is involved in maintaining the map.
+/// This is the preferred container for larger numbers of aircraft.
+typedef std::unordered_map<uint64_t,SPtrLTAPIAircraft> MapLTAPIAircraftNum;
+
 /// @brief Simple list of smart pointers to LTAPIAircraft objects
 ///
 /// This is used to return aircraft objects which got removed by LiveTraffic,
 /// see LTAPIConnect::UpdateAcList()
 typedef std::list<SPtrLTAPIAircraft> ListLTAPIAircraft;
 
+/// @brief Vector of smart pointers to LTAPIAircraft objects
+///
+/// Alternative to ListLTAPIAircraft for receiving removed aircraft,
+/// see LTAPIConnect::UpdateAcListNumVec(). If you `clear()` it after processing,
+/// its capacity is kept and no allocation is required for removed aircraft
+/// in later calls.
+typedef std::vector<SPtrLTAPIAircraft> VecLTAPIAircraft;
+
+/// @brief Structure-of-arrays view of all aircraft's numeric data
+/// @details Maintained by LTAPIConnect::UpdateAcList() if enabled via
+///          LTAPIConnect::EnableColumns(). Each aircraft occupies one row,
+///          the same index in all columns. Rows are updated in place with each
+///          numeric fetch. New aircraft are appended, removed aircraft are
+///          replaced by the last row, so row order is arbitrary and
+///          indexes are only valid until the next UpdateAcList() call.
+struct LTAPIAcColumns {
+    /// Bits in the `flags` column
+    enum FlagsTy : uint8_t {
+        FL_ON_GND   = 0x01,             ///< on ground
+        FL_HIDDEN   = 0x02,             ///< not visible
+        FL_CAMERA   = 0x04,             ///< LiveTraffic's camera is on this aircraft
+        FL_LANDING  = 0x08,             ///< landing lights
+        FL_TAXI     = 0x10,             ///< taxi lights
+        FL_BCN      = 0x20,             ///< beacon light
+        FL_STRB     = 0x40,             ///< strobe light
+        FL_NAV      = 0x80,             ///< navigation lights
+    };
+    
+    /// Number of samples kept per aircraft in the `hist` column
+    static constexpr unsigned HIST_SIZE = 4;
+    /// One sample of an aircraft's position and attitude
+    struct Sample {
+        int64_t     ts_ns;              ///< [ns] `steady_clock` time of the fetch
+        double      lat;                ///< [°] latitude
+        double      lon;                ///< [°] longitude
+        double      alt_ft;             ///< [ft] altitude
+        float       heading;            ///< [°] heading
+        float       pitch;              ///< [°] pitch: positive up
+        float       roll;               ///< [°] roll: positive right
+        float       q[4];               ///< same attitude as unit quaternion w, x, y, z
+    };
+    /// Ring buffer of the last `HIST_SIZE` samples of one aircraft
+    struct History {
+        Sample      s[HIST_SIZE];       ///< the samples
+        uint8_t     next = 0;           ///< index of the slot to write next, i.e. the oldest sample
+        uint8_t     num = 0;            ///< number of valid samples
+    };
+    /// Interpolated position and attitude, see interpolate()
+    struct Pose {
+        double      lat;                ///< [°] latitude
+        double      lon;                ///< [°] longitude
+        double      alt_ft;             ///< [ft] altitude
+        float       heading;            ///< [°] heading
+        float       pitch;              ///< [°] pitch: positive up
+        float       roll;               ///< [°] roll: positive right
+    };
+    
+    std::vector<uint64_t>   key;        ///< LTAPIAircraft::getKeyNum()
+    std::vector<double>     lat;        ///< [°] latitude
+    std::vector<double>     lon;        ///< [°] longitude
+    std::vector<double>     alt_ft;     ///< [ft] altitude
+    std::vector<float>      heading;    ///< [°] heading
+    std::vector<float>      track;      ///< [°] track over ground
+    std::vector<float>      speed_kt;   ///< [kt] ground speed
+    std::vector<float>      vsi_ft;     ///< [ft/minute] vertical speed, positive up
+    std::vector<float>      dist_nm;    ///< [nm] distance to current camera
+    std::vector<uint8_t>    phase;      ///< flight phase, see LTAPIAircraft::LTFlightPhase
+    std::vector<uint8_t>    flags;      ///< combination of FlagsTy bits
+    std::vector<int64_t>    tsBulk_ns;  ///< [ns] `steady_clock` time of the last numeric fetch, see LTAPIAircraft::getBulkTime()
+    std::vector<History>    hist;       ///< last samples of each aircraft, only maintained if `bHist`
+    std::vector<double>     x;          ///< local x coordinate, valid if `localGen` matches, see LTAPIConnect::UpdateLocalCoords()
+    std::vector<double>     y;          ///< local y coordinate, valid if `localGen` matches
+    std::vector<double>     z;          ///< local z coordinate, valid if `localGen` matches
+    std::vector<uint32_t>   localGen;   ///< LTAPILocalFrame::gen `x/y/z` were computed with, `0` if position changed since
+    std::vector<LTAPIAircraft*> ac;     ///< the aircraft object this row represents
+    /// Maintain the `hist` column? Set via LTAPIConnect::EnableInterpolation()
+    bool                    bHist = false;
+    
+    /// Number of rows
+    size_t size () const { return key.size(); }
+    /// Removes all rows, keeps capacity
+    void clear ();
+    /// Appends a row for the given aircraft
+    void push_back (LTAPIAircraft* pAc);
+    /// Updates row `i` from its aircraft object
+    void set (size_t i);
+    /// @brief Removes row `i` by moving the last row into its place
+    /// @return Aircraft, which moved into row `i`, `nullptr` if `i` was the last row
+    LTAPIAircraft* swapRemove (size_t i);
+    
+    /// @name Vectorized queries
+    /// @details Scan the position columns using SSE2 or AVX (see `LTAPI_SIMD`)
+    ///          with a scalar fallback. All return the number of matches and
+    ///          fill `outIdx` with the matching row indexes in ascending order.
+    ///          `outIdx` is cleared first, but keeps its capacity between calls.
+    /// @{
+    
+    /// @brief Rows within `nm` nautical miles of the given position
+    /// @note Uses an equirectangular approximation, good for radii up to a few hundred nm
+    size_t findWithinRadius (double lat, double lon, double nm,
+                             std::vector<uint32_t>& outIdx) const;
+    /// @brief Rows inside the given lat/lon box, `lonMin > lonMax` denotes a box crossing the antimeridian
+    size_t findInBox (double latMin, double latMax, double lonMin, double lonMax,
+                      std::vector<uint32_t>& outIdx) const;
+    /// Rows with an altitude in [altMin_ft, altMax_ft]
+    size_t findInAltBand (double altMin_ft, double altMax_ft,
+                          std::vector<uint32_t>& outIdx) const;
+    /// @}
+    
+    /// @brief Dead reckoning of all rows, see LTAPIAircraft::extrapolate()
+    /// @param ts Point in time to extrapolate to, typically `std::chrono::steady_clock::now()`
+    /// @param[out] outLat [°] latitudes, resized to size(), same index as the columns
+    /// @param[out] outLon [°] longitudes, resized to size()
+    /// @param[out] outAlt_ft [ft] altitudes, resized to size()
+    void extrapolate (std::chrono::time_point<std::chrono::steady_clock> ts,
+                      std::vector<double>& outLat, std::vector<double>& outLon,
+                      std::vector<double>& outAlt_ft) const;
+    
+    /// @brief Positions and attitudes of all rows interpolated between buffered samples
+    /// @details Unlike extrapolate() never overshoots, but lags behind:
+    ///          Pass a point in time one update interval in the past so that
+    ///          it usually lies between two fetched samples. Positions are
+    ///          interpolated linearly, attitudes are slerped (for rotations
+    ///          of less than about 3.6°, where it makes no visible difference,
+    ///          angles are interpolated linearly instead). Before the oldest
+    ///          or after the newest sample the respective sample is returned.
+    ///          Requires the `hist` column, see LTAPIConnect::EnableInterpolation().
+    /// @param ts Point in time to interpolate at, typically `now` minus the update interval
+    /// @param[out] outPose Resized to size(), same index as the columns
+    void interpolate (std::chrono::time_point<std::chrono::steady_clock> ts,
+                      std::vector<Pose>& outPose) const;
+};
+
+/// @brief Conversion of world to X-Plane's local coordinates without calling into X-Plane
+/// @details X-Plane's local coordinates are a rigid transformation of
+///          Earth-centered, Earth-fixed (ECEF) coordinates of a spherical earth.
+///          calibrate() determines that transformation with a few calls to
+///          `XPLMLocalToWorld`/`XPLMWorldToLocal` around the local origin, after which toLocal()
+///          converts any number of positions on its own.
+///          isShifted() tells with one call if X-Plane has moved its local origin since.
+struct LTAPILocalFrame {
+    double      m[3][3] = {{0.0}};      ///< linear part: ECEF offset to local offset
+    double      ecef0[3] = {0.0};       ///< ECEF of the reference point
+    double      local0[3] = {0.0};      ///< local coordinates of the reference point
+    double      lat0 = 0.0;             ///< [°] reference point, X-Plane's local origin during calibration
+    double      lon0 = 0.0;             ///< [°] reference point
+    double      alt0_m = 0.0;           ///< [m] reference point
+    uint32_t    gen = 0;                ///< increases with each calibration, `0` if not calibrated
+    
+    /// Determines the transformation for X-Plane's current local origin
+    void calibrate ();
+    /// Has X-Plane moved its local origin since calibrate()? (One call to `XPLMWorldToLocal`)
+    bool isShifted () const;
+    /// @brief Converts a position to local coordinates, same as `XPLMWorldToLocal`
+    /// @param lat [°] latitude
+    /// @param lon [°] longitude
+    /// @param alt_m [m] altitude
+    /// @param[out] x Local x coordinate
+    /// @param[out] y Local y coordinate
+    /// @param[out] z Local z coordinate
+    void toLocal (double lat, double lon, double alt_m,
+                  double& x, double& y, double& z) const;
+    /// Earth-centered, Earth-fixed coordinates of a position on a spherical earth
+    static void ToECEF (double lat, double lon, double alt_m, double ecef[3]);
+};
+
+/// @brief Spatial index of aircraft positions in a lat/lon bucket grid
+/// @details Maintained incrementally by LTAPIConnect::UpdateAcList() if enabled via
+///          LTAPIConnect::EnableGrid(): Only aircraft, whose cell changes, are moved.
+///          Queries only visit cells close to the query position,
+///          so their cost depends on local traffic density, not on fleet size.
+///          Distances use the same equirectangular approximation
+///          as LTAPIAcColumns::findWithinRadius().
+class LTAPIGridIndex
+{
+public:
+    /// One query result
+    struct Hit {
+        double          dist_nm;        ///< [nm] distance to query position
+        LTAPIAircraft*  pAc;            ///< the aircraft
+    };
+    /// Query results
+    typedef std::vector<Hit> VecHit;
+    
+protected:
+    double      cellDeg = 0.5;          ///< [°] cell size
+    uint64_t    nx = 720;               ///< number of cells around a circle of latitude
+    uint64_t    ny = 360;               ///< number of cells from pole to pole
+    size_t      numAc = 0;              ///< number of aircraft in the index
+    /// Aircraft per cell; emptied cells are kept to avoid reallocation
+    std::unordered_map<uint64_t, std::vector<LTAPIAircraft*>> mapCells;
+    
+public:
+    /// Defines cell size and removes all aircraft
+    void init (double _cellDeg);
+    /// Removes all aircraft
+    void clear ();
+    /// Adds an aircraft to the index
+    void insert (LTAPIAircraft* pAc);
+    /// Moves an aircraft to another cell if its position requires so
+    void update (LTAPIAircraft* pAc);
+    /// Removes an aircraft from the index
+    void remove (LTAPIAircraft* pAc);
+    
+    /// Number of aircraft in the index
+    size_t size () const { return numAc; }
+    /// [°] cell size
+    double getCellDeg () const { return cellDeg; }
+    
+    /// @brief All aircraft within `nm` nautical miles of the given position
+    /// @param[out] outHits Cleared, then receives the aircraft found, unsorted
+    /// @return Number of aircraft found
+    size_t withinRadius (double lat, double lon, double nm, VecHit& outHits) const;
+    /// @brief The `n` aircraft nearest to the given position
+    /// @details Searches rings of cells around the position until
+    ///          no unvisited cell can contain a closer aircraft.
+    /// @param[out] outHits Cleared, then receives up to `n` aircraft, sorted by distance
+    /// @return Number of aircraft found
+    size_t nearestN (double lat, double lon, size_t n, VecHit& outHits) const;
+    
+protected:
+    /// Cell key of a position
+    uint64_t cellOf (double lat, double lon) const;
+    /// Adds all aircraft of the given cell within `r2` squared nm to `outHits`
+    void collect (uint64_t iy, uint64_t ix, double lat0, double lon0, double kx,
+                  double r2, VecHit& outHits) const;
+};
+
+/// @brief Immutable copy of all aircraft data as of the end of one UpdateAcList() call
+/// @details Published by LTAPIConnect if enabled via LTAPIConnect::EnableSnapshots(),
+///          acquired by any thread via LTAPIConnect::getSnapshot().
+///          A snapshot never changes once published. It is released when the
+///          last reader lets go of its smart pointer.
+struct LTAPISnapshot {
+    uint64_t        seq = 0;            ///< sequence number, increases with each published snapshot
+    std::chrono::time_point<std::chrono::steady_clock> ts;  ///< time of publishing
+    std::vector<LTAPIAircraft::LTAPIBulkData>      vBulk;   ///< numeric data of all aircraft, sorted by `keyNum`
+    std::vector<LTAPIAircraft::LTAPIBulkInfoTexts> vInfo;   ///< textual data of all aircraft, same index as `vBulk`
+    
+    /// Number of aircraft
+    size_t size () const { return vBulk.size(); }
+    /// Index of aircraft with given key, or `-1` if not found (binary search)
+    long find (uint64_t keyNum) const;
+};
+
+/// Smart pointer to a published, immutable snapshot
+typedef std::shared_ptr<const LTAPISnapshot> SPtrLTAPISnapshot;
+
+/// @brief One change of the aircraft list reported by UpdateAcList()
+/// @see LTAPIConnect::EnableEvents(), LTAPIConnect::getEvents()
+struct LTAPIAcEvent {
+    /// Kind of change
+    enum EventTy : uint8_t {
+        EV_ADDED = 0,                   ///< aircraft object created
+        EV_UPDATED,                     ///< data of an existing aircraft changed
+        EV_REMOVED,                     ///< aircraft object removed
+    };
+    uint64_t        keyNum = 0;         ///< key of the aircraft, see LTAPIAircraft::getKeyNum()
+    EventTy         ev = EV_ADDED;      ///< kind of change
+};
+
+/// Events of one UpdateAcList() call
+typedef std::vector<LTAPIAcEvent> VecLTAPIAcEvent;
+
+/// @brief Slab memory pool for aircraft objects and their `shared_ptr` control blocks
+/// @details Hands out fixed-size blocks per requested size from slabs,
+///          which grow in size as more blocks are needed. Freed blocks go back
+///          to a free list for reuse. Memory is returned to the system only
+///          when the pool is destroyed, which happens when LTAPIConnect and
+///          all aircraft objects allocated from the pool are gone.
+///          Blocks can be freed from any thread.
+/// @see LTAPIPoolAllocator, LTAPIConnect::CreatePooled()
+class LTAPIAcPool
+{
+protected:
+    /// Free list and growth of one block size
+    struct SizeClass {
+        size_t  size = 0;               ///< block size
+        void*   pFree = nullptr;        ///< first free block, each free block holds a pointer to the next
+        size_t  numNextSlab = 16;       ///< number of blocks in the next slab to allocate
+    };
+    std::vector<SizeClass>              vClasses;   ///< all block sizes in use
+    std::vector<std::unique_ptr<char[]>> vSlabs;    ///< all slabs allocated
+    size_t      bytesSlabs = 0;         ///< total size of all slabs
+    size_t      numInUse = 0;           ///< number of blocks handed out
+    mutable std::mutex mtx;             ///< guards all of the above
+    
+public:
+    /// Largest block size served by the pool, larger requests go to `operator new`
+    static constexpr size_t MAX_BLOCK = 4096;
+    
+    /// Returns a block of at least `size` bytes
+    void* alloc (size_t size);
+    /// Returns a block to the pool, `size` must be the same as passed to alloc()
+    void free (void* p, size_t size);
+    
+    /// Number of blocks currently handed out
+    size_t getNumInUse () const
+    { std::lock_guard<std::mutex> lock(mtx); return numInUse; }
+    /// Total number of bytes allocated for slabs
+    size_t getBytesReserved () const
+    { std::lock_guard<std::mutex> lock(mtx); return bytesSlabs; }
+    
+protected:
+    /// Block size used for a requested size, multiple of the default alignment
+    static size_t BlockSize (size_t size)
+    {
+        constexpr size_t align = alignof(std::max_align_t);
+        return (std::max(size, sizeof(void*)) + align - 1) / align * align;
+    }
+};
+
+/// @brief Standard allocator serving from an LTAPIAcPool, for use with `std::allocate_shared`
+/// @details Holds a smart pointer to the pool, so the pool lives as long as
+///          any object (or rather its `shared_ptr` control block) allocated from it.
+template <class T>
+class LTAPIPoolAllocator
+{
+public:
+    typedef T value_type;               ///< type of allocated objects
+    std::shared_ptr<LTAPIAcPool> spPool;    ///< the pool to allocate from
+    
+    /// Constructor takes the pool
+    LTAPIPoolAllocator (std::shared_ptr<LTAPIAcPool> _spPool) : spPool(std::move(_spPool)) {}
+    /// Rebinding copy constructor
+    template <class U>
+    LTAPIPoolAllocator (const LTAPIPoolAllocator<U>& o) : spPool(o.spPool) {}
+    
+    /// Allocates memory for `n` objects of type `T`
+    T* allocate (size_t n)
+    {
+        if (alignof(T) > alignof(std::max_align_t))
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(spPool->alloc(n * sizeof(T)));
+    }
+    /// Returns memory of `n` objects of type `T`
+    void deallocate (T* p, size_t n)
+    {
+        if (alignof(T) > alignof(std::max_align_t))
+            ::operator delete(p);
+        else
+            spPool->free(p, n * sizeof(T));
+    }
+    
+    /// Allocators are equal if they share the same pool
+    template <class U>
+    bool operator== (const LTAPIPoolAllocator<U>& o) const { return spPool == o.spPool; }
+    /// Allocators are equal if they share the same pool
+    template <class U>
+    bool operator!= (const LTAPIPoolAllocator<U>& o) const { return spPool != o.spPool; }
+};
+
+/// @brief Compile-time switch for LTAPIConnect's statistics
+/// @details Define as `0` to compile out all time measurement and counting
+///          done in UpdateAcList(). LTAPIConnect::getStats() then returns all zeros.
+#ifndef LTAPI_STATS
+#define LTAPI_STATS 1
+#endif
+
 /// @brief Connects to LiveTraffic's dataRefs and returns aircraft information.
 ///
 /// Typically, exactly one instance of this class is used.
@@ -330,11 +795,100 @@ public:
     /// a new aircraft object.
     typedef LTAPIAircraft* fCreateAcObject();
     
+    /// @brief Callback function type passed in to LTAPIConnect() for pooled allocation
+    /// @details Creates a new LTAPIAircraft object or derived class' object,
+    ///          typically with its control block in one allocation from the pool.
+    ///          Use CreatePooled(), like `LTAPIConnect::CreatePooled<EnhAircraft>`.
+    /// @param spPool The pool to allocate from
+    typedef SPtrLTAPIAircraft fCreateAcShared(const std::shared_ptr<LTAPIAcPool>& spPool);
+    
+    /// @brief Creates a new aircraft object of type `AcT` from the pool, see fCreateAcShared()
+    /// @tparam AcT LTAPIAircraft or derived class, must be default constructible
+    template <class AcT>
+    static SPtrLTAPIAircraft CreatePooled (const std::shared_ptr<LTAPIAcPool>& spPool)
+    { return std::allocate_shared<AcT>(LTAPIPoolAllocator<AcT>(spPool)); }
+    
+    /// @brief Callback function type for RegisterEventCB()
+    /// @details Called at the end of UpdateAcList() if there were any events.
+    ///          Aircraft reported as removed are no longer in the maps.
+    /// @param lt The LTAPIConnect object that updated its aircraft list
+    /// @param vEvents The events of this UpdateAcList() call
+    /// @param refcon The reference value passed to RegisterEventCB()
+    typedef void fAcEventCB(LTAPIConnect& lt, const VecLTAPIAcEvent& vEvents, void* refcon);
+    
     /// Number of seconds between two calls of the expensive type,
     /// which fetches all texts from LiveTraffic, which in fact don't change
     /// that often anyway
     std::chrono::seconds sPeriodExpsv = std::chrono::seconds(3);
     
+    /// @brief Time budget per UpdateAcList() call, `0` for no limit
+    /// @details If set, fetching stops after the bulk, during which the budget
+    ///          got exhausted, and the next call resumes at that offset
+    ///          (or rather right after the last aircraft already updated,
+    ///          in case LiveTraffic has added or removed aircraft in between).
+    ///          A sweep over all aircraft, including an expensive fetch if due,
+    ///          can then span several calls. Aircraft are only removed once
+    ///          a sweep has completed, see isSweepComplete(), which is also when
+    ///          getAcByMultIdx() and getAcInCameraView() switch to what the sweep found.
+    ///          Not applied while recording or replaying, so that capture files
+    ///          always contain complete cycles.
+    std::chrono::microseconds usUpdateBudget = std::chrono::microseconds(0);
+    
+    /// @brief Spread the expensive fetch over all calls instead of fetching all texts every `sPeriodExpsv`?
+    /// @details If set, each UpdateAcList() call refreshes the texts of a share of
+    ///          all aircraft proportional to the time passed since the previous call,
+    ///          round-robin, so that all texts are still refreshed once per `sPeriodExpsv`.
+    ///          Texts of new aircraft are fetched right away in the same call,
+    ///          only for the offsets at which they appeared.
+    bool bSliceExpsv = false;
+    
+    /// Level-of-detail tier, see EnableLOD()
+    struct LODTier {
+        float       maxDist_nm;         ///< [nm] aircraft closer than this to the camera belong to this tier
+        unsigned    intvl;              ///< numeric data is fetched every `intvl`-th call
+    };
+    
+    /// Values measured during UpdateAcList(), per call or summed up
+    struct UpdateStats {
+        uint64_t    nsTotal     = 0;    ///< [ns] wall time of UpdateAcList()
+        uint64_t    nsQuick     = 0;    ///< [ns] time spent in `XPLMGetDatab` for the quick fetch
+        uint64_t    nsExpsv     = 0;    ///< [ns] time spent in `XPLMGetDatab` for the expensive fetch
+        uint64_t    numGetData  = 0;    ///< number of `XPLMGetDatab` round trips, incl. size negotiation
+        uint64_t    bytesQuick  = 0;    ///< bytes transferred by the quick fetch
+        uint64_t    bytesExpsv  = 0;    ///< bytes transferred by the expensive fetch
+        uint64_t    numCreated  = 0;    ///< aircraft objects created
+        uint64_t    numUpdated  = 0;    ///< existing aircraft objects updated by the quick fetch
+        uint64_t    numRemoved  = 0;    ///< aircraft objects removed
+        uint64_t    numExpsv    = 0;    ///< number of expensive fetches (`1` per call if it ran)
+        
+        /// Adds up another set of values
+        void add (const UpdateStats& o);
+    };
+    
+    /// Statistics of UpdateAcList() calls, see getStats()
+    struct Stats {
+        /// Number of calls in the rolling latency window
+        static constexpr unsigned LAT_WINDOW = 256;
+        /// Number of histogram buckets, bucket `i` counts latencies in [2^i, 2^(i+1)) ns
+        static constexpr unsigned LAT_BUCKETS = 32;
+        
+        uint64_t    numCalls = 0;       ///< number of UpdateAcList() calls
+        UpdateStats last;               ///< values of the last call
+        UpdateStats total;              ///< cumulative values of all calls
+        uint32_t    latRing[LAT_WINDOW] = {0};      ///< [ns] wall time of the last `LAT_WINDOW` calls (ring buffer)
+        uint32_t    latHist[LAT_BUCKETS] = {0};     ///< log2 histogram of the latencies in `latRing`
+        
+        /// Number of valid entries in the rolling latency window
+        unsigned getLatCount () const
+        { return numCalls < LAT_WINDOW ? unsigned(numCalls) : LAT_WINDOW; }
+        /// @brief Latency percentile over the rolling window
+        /// @param p Percentile [0.0..1.0], like `0.99`
+        /// @return [ns] latency, `0` if no calls recorded yet
+        uint32_t getLatPercentile (double p) const;
+        /// Adds one call's values, called at the end of UpdateAcList()
+        void addCall (const UpdateStats& call);
+    };
+    
 protected:
     /// Number of aircraft to fetch in one bulk operation
     const int iBulkAc = 50;
@@ -346,13 +900,129 @@ protected:
 protected:
     /// Pointer to callback function returning new aircraft objects
     fCreateAcObject* pfCreateAcObject = nullptr;
+    /// Pointer to callback function returning new pooled aircraft objects
+    fCreateAcShared* pfCreateAcShared = nullptr;
+    /// Pool for aircraft objects if created via `pfCreateAcShared`
+    std::shared_ptr<LTAPIAcPool> spPool;
     
-    /// THE map of aircrafts
+    /// THE map of aircrafts, keyed by numeric key
+    MapLTAPIAircraftNum mapAcNum;
+    /// Map of aircrafts keyed by hex string, only maintained once UpdateAcList() was called
     MapLTAPIAircraft mapAc;
+    /// Shall `mapAc` be maintained? Becomes `true` with the first call to UpdateAcList()
+    bool bMapStr = false;
     
     /// Last fetching of expensive data
     std::chrono::time_point<std::chrono::steady_clock> lastExpsvFetch;
     
+    /// Offset at which the next call resumes the current sweep, `0` if the next call starts a new sweep
+    int sweepAc = 0;
+    /// Is the current sweep in its expensive fetch (otherwise in its numeric fetch)?
+    bool bSweepExpsv = false;
+    /// Did the current sweep create new aircraft?
+    bool bSweepNewAc = false;
+    /// Number of aircraft LiveTraffic reported during the previous call
+    int sweepNumAc = 0;
+    
+    /// Ranges of bulk offsets `[first, second)`
+    typedef std::vector<std::pair<int,int> > VecAcRange;
+    /// Offset at which the next slice of the sliced expensive fetch starts
+    int expsvAc = 0;
+    /// Number of aircraft due for the sliced expensive fetch, fractional remainder kept for the next call
+    double expsvQuota = 0.0;
+    /// Offsets of aircraft created during this call, their texts are fetched right away if `bSliceExpsv`
+    std::vector<int> vNewAcIdx;
+    /// Ranges to fetch during the sliced expensive fetch of this call
+    VecAcRange vExpsvRanges;
+    
+    /// Shall UpdateAcList() fetch numeric data by level-of-detail tiers?
+    bool bLOD = false;
+    /// Level-of-detail tiers, sorted by distance
+    std::vector<LODTier> vLODTiers;
+    /// Every `lodFullIntvl`-th call fetches all aircraft
+    unsigned lodFullIntvl = 8;
+    /// Number of calls since the last full fetch
+    unsigned lodCall = 0;
+    /// Ranges to fetch during the numeric fetch of a level-of-detail call
+    VecAcRange vLODRanges;
+    
+    /// @brief Positional hint cache: aircraft seen at each bulk offset during last fetch
+    /// @details LiveTraffic returns aircraft in a fairly stable order.
+    ///          So we first check if the aircraft at the same offset last time
+    ///          still has the same key, then if it is the aircraft that followed
+    ///          the previous one last time (which covers aircraft being
+    ///          inserted or removed in between). Only if both fail we search `mapAcNum`.
+    ///          Only contains aircraft seen during the last numeric fetch,
+    ///          so all pointers are valid until the next removal of aircraft.
+    std::vector<LTAPIAircraft*> vHint;
+    /// Hint cache being built during the current numeric fetch, swapped with `vHint` afterwards
+    std::vector<LTAPIAircraft*> vHintNext;
+    /// Number of aircraft found via the hint cache
+    uint64_t numHintHits = 0;
+    /// Number of aircraft that required a map lookup
+    uint64_t numHintMisses = 0;
+    
+    /// Capture file, if recording
+    FILE* fCapture = nullptr;
+    /// Start of recording, reference for record timestamps
+    std::chrono::time_point<std::chrono::steady_clock> tsCaptureStart;
+    /// Memory-mapped capture file, if replaying
+    std::unique_ptr<LTAPIReplay> pReplay;
+    
+    /// Statistics of UpdateAcList() calls
+    Stats stats;
+    /// Values measured during the current UpdateAcList() call
+    UpdateStats statsCall;
+    /// Own dataRefs publishing statistics, if requested
+    std::unique_ptr<LTAPIStatsDataRefs> pStatsDR;
+    
+    /// Number of multiplayer slots, `bits.multiIdx` is an 8 bit signed value
+    static constexpr int MAX_MULTI_IDX = 128;
+    /// Aircraft per multiplayer slot, as of the last complete sweep
+    LTAPIAircraft* aMultiIdxAc[MAX_MULTI_IDX] = {nullptr};
+    /// Aircraft LiveTraffic's camera is on, as of the last complete sweep
+    LTAPIAircraft* pCameraAc = nullptr;
+    /// Slot table being rebuilt by the numeric fetch of the current sweep, replaces `aMultiIdxAc` once the sweep is complete
+    LTAPIAircraft* aMultiIdxAcNext[MAX_MULTI_IDX] = {nullptr};
+    /// Camera aircraft found by the numeric fetch of the current sweep, replaces `pCameraAc` once the sweep is complete
+    LTAPIAircraft* pCameraAcNext = nullptr;
+    
+    /// Shall UpdateAcList() maintain `cols`?
+    bool bCols = false;
+    /// Structure-of-arrays view of all aircraft
+    LTAPIAcColumns cols;
+    
+    /// Shall UpdateAcList() maintain `grid`?
+    bool bGrid = false;
+    /// Spatial grid index of all aircraft
+    LTAPIGridIndex grid;
+    
+    /// Hashed indexes by call sign, registration, and flight number, if enabled
+    std::unique_ptr<LTAPITextIndex> pTextIdx;
+    
+    /// Conversion to local coordinates used by UpdateLocalCoords()
+    LTAPILocalFrame localFrame;
+    
+    /// Shall UpdateAcList() publish snapshots?
+    bool bSnapshots = false;
+    /// Currently published snapshot, only to be accessed via `std::atomic_load/store`
+    SPtrLTAPISnapshot spSnapshot;
+    /// Previous snapshot, which no reader held any longer, reused for the next one
+    std::shared_ptr<LTAPISnapshot> spSnapSpare;
+    /// Keys and aircraft in the order of the next snapshot, kept to avoid allocations
+    std::vector<std::pair<uint64_t,const LTAPIAircraft*> > vSnapOrder;
+    /// Sequence number of last published snapshot
+    uint64_t snapSeq = 0;
+    
+    /// Shall UpdateAcList() report events?
+    bool bEvents = false;
+    /// Events of the last UpdateAcList() call
+    VecLTAPIAcEvent vEvents;
+    /// Number of UpdateAcList() calls with events enabled, marks aircraft already reported in `LTAPIAircraft::evCycle`
+    uint64_t evCycle = 0;
+    /// Registered event callbacks with their reference values
+    std::vector<std::pair<fAcEventCB*,void*> > vEventCB;
+    
 public:
     /// @brief Constructor
     /// @param _pfCreateAcObject (Optional) Poitner to callback function,
@@ -360,6 +1030,15 @@ public:
     /// @param numBulkAc Number of aircraft to fetch in one bulk operation
     LTAPIConnect(fCreateAcObject* _pfCreateAcObject = LTAPIAircraft::CreateNewObject,
                  int numBulkAc = 50);
+    /// @brief Constructor for pooled allocation of aircraft objects
+    /// @details Aircraft objects and their `shared_ptr` control blocks
+    ///          are allocated together from a slab pool, which avoids
+    ///          two heap allocations per new aircraft.
+    /// @param _pfCreateAcShared Pointer to callback function, which returns
+    ///        new aircraft objects allocated from the pool, like `LTAPIConnect::CreatePooled<EnhAircraft>`
+    /// @param numBulkAc Number of aircraft to fetch in one bulk operation
+    LTAPIConnect(fCreateAcShared* _pfCreateAcShared,
+                 int numBulkAc = 50);
     virtual ~LTAPIConnect();
     
     /// Is LiveTraffic available? (checks via XPLMFindPluginBySignature)
@@ -418,32 +1097,318 @@ public:
     ///        LTAPI will only _emplace_back_ to the list, never remove anything.
     const MapLTAPIAircraft& UpdateAcList (ListLTAPIAircraft* plistRemovedAc = nullptr);
     
-    /// Returns the map of aircraft as it currently stands
+    /// @brief Main function, numeric version: updates map of aircrafts and returns reference to it.
+    /// @details Same as UpdateAcList(), but maintains and returns the map keyed
+    ///          by the aircraft's numeric key only. No key string is ever built,
+    ///          unless you call LTAPIAircraft::getKey().
+    /// @param plistRemovedAc (Optional) receives removed aircraft, see UpdateAcList()
+    /// @note Once warmed up, ie. after the first calls have sized internal buffers,
+    ///       this function does not allocate any heap memory as long as
+    ///       no aircraft are added. Removed aircraft are only moved to
+    ///       `plistRemovedAc`, which allocates list nodes. Use
+    ///       UpdateAcListNumVec() to avoid that, too.
+    const MapLTAPIAircraftNum& UpdateAcListNum (ListLTAPIAircraft* plistRemovedAc = nullptr);
+    
+    /// @brief Main function, numeric version, returning removed aircraft in a vector
+    /// @details Same as UpdateAcListNum(), but allocation-free also when aircraft are removed,
+    ///          as long as `pvecRemovedAc` has enough capacity.
+    /// @param pvecRemovedAc Receives removed aircraft, LTAPI will only _emplace_back_ to it
+    const MapLTAPIAircraftNum& UpdateAcListNumVec (VecLTAPIAircraft* pvecRemovedAc);
+    
+    /// @brief Returns the map of aircraft as it currently stands
+    /// @note This map is only maintained if you use UpdateAcList().
+    ///       If you use UpdateAcListNum() call getAcMapNum() instead.
     const MapLTAPIAircraft& getAcMap () const { return mapAc; }
     
+    /// Returns the map of aircraft, keyed by numeric key, as it currently stands
+    const MapLTAPIAircraftNum& getAcMapNum () const { return mapAcNum; }
+    
     /// @brief Finds an aircraft for a given multiplayer slot
+    /// @details Constant time, uses a slot table maintained by UpdateAcList()
     /// @param multiIdx The multiplayer index to look for
     /// @return Pointer to aircraft in slot `multiIdx`, is empty if not found
     SPtrLTAPIAircraft getAcByMultIdx (int multiIdx) const;
 
     /// @brief Returns the aircraft being viewed in LiveTraffic's camera view, if any
+    /// @details Constant time, returns the camera aircraft as of the last UpdateAcList() call
     /// @return Pointer to aircraft in camera view, is empty if none is being viewed
     SPtrLTAPIAircraft getAcInCameraView () const;
     
     /// @brief Clear camera information, ie. delcare that no aircraft is currently being viewed
     void clearCameraInfo ();
     
+    /// Number of aircraft found via the positional hint cache, ie. without map lookup
+    uint64_t getHintHits () const { return numHintHits; }
+    /// Number of aircraft, which required a map lookup
+    uint64_t getHintMisses () const { return numHintMisses; }
+    /// Share of aircraft found via positional hint cache [0.0..1.0]
+    double getHintHitRate () const
+    { return numHintHits + numHintMisses ? double(numHintHits) / double(numHintHits + numHintMisses) : 0.0; }
+    /// Resets the hint cache counters
+    void resetHintStats () { numHintHits = numHintMisses = 0; }
+    
+    /// @brief Statistics of UpdateAcList() calls
+    /// @details Covers time spent in `XPLMGetDatab`, round trips, bytes transferred,
+    ///          aircraft created/updated/removed, and a rolling latency histogram.
+    ///          Counters are cumulative until resetStats().
+    ///          All zero if compiled with `LTAPI_STATS=0`.
+    const Stats& getStats () const { return stats; }
+    /// Resets all statistics
+    void resetStats () { stats = Stats(); }
+    
+    /// @brief Registers own read-only dataRefs publishing performance metrics
+    /// @details Registers `ltapi/<pluginName>/...` dataRefs, which are refreshed
+    ///          once per UpdateAcList() call:
+    ///          - `aircraft`: number of aircraft
+    ///          - `update_us`, `getdata_us`: [µs] wall time of last UpdateAcList() call, time spent in `XPLMGetDatab`
+    ///          - `getdata_calls`: number of `XPLMGetDatab` round trips in last call
+    ///          - `update_us_p50`, `update_us_p99`: [µs] latency percentiles over the last 256 calls
+    ///          - `bytes_per_sec`: bytes transferred from LiveTraffic per second
+    ///          - `created`, `removed`: total number of aircraft objects created/removed
+    ///          - `hint_hit_rate`: share of aircraft found via positional hint cache
+    ///
+    ///          Percentiles and transfer rate are refreshed once per second only.
+    ///          If DataRefTool is installed it is informed about the new dataRefs.
+    /// @note Most values stay zero if compiled with `LTAPI_STATS=0`.
+    /// @param pluginName Your plugin's name, forms part of the dataRef names
+    /// @return Have the dataRefs been registered?
+    bool PublishStatsDataRefs (const std::string& pluginName);
+    /// Unregisters the dataRefs registered by PublishStatsDataRefs()
+    void UnpublishStatsDataRefs ();
+    /// Are statistics dataRefs published?
+    bool isPublishingStats () const { return bool(pStatsDR); }
+    
+    /// @brief Enables maintaining a structure-of-arrays view of all aircraft
+    /// @details If enabled, UpdateAcList() maintains contiguous columns
+    ///          of the most important numeric values of all aircraft,
+    ///          so that bulk processing can stream over them, see getColumns().
+    /// @param bEnable Enable or disable; enabling fills the columns from the current aircraft
+    void EnableColumns (bool bEnable = true);
+    /// Is the structure-of-arrays view maintained?
+    bool areColumnsEnabled () const { return bCols; }
+    /// Structure-of-arrays view of all aircraft, empty unless enabled via EnableColumns()
+    const LTAPIAcColumns& getColumns () const { return cols; }
+    
+    /// @brief Enables buffering the last samples of each aircraft for interpolation
+    /// @details Enables the structure-of-arrays view, too, which then maintains
+    ///          its `hist` column, see LTAPIAcColumns::interpolate().
+    /// @param bEnable Enable or disable; disabling keeps the structure-of-arrays view enabled
+    void EnableInterpolation (bool bEnable = true);
+    /// Are samples buffered for interpolation?
+    bool isInterpolationEnabled () const { return cols.bHist; }
+    
+    /// @brief Converts positions of all aircraft to local coordinates into the `x/y/z` columns
+    /// @details Requires the structure-of-arrays view, see EnableColumns().
+    ///          Results are cached per row: Only rows, whose position changed
+    ///          since the last call, are converted, unless X-Plane has moved
+    ///          its local origin, which is checked with one call to `XPLMWorldToLocal`.
+    ///          The conversion itself does not call into X-Plane, see LTAPILocalFrame.
+    /// @return Number of rows converted
+    size_t UpdateLocalCoords ();
+    /// Conversion to local coordinates as last calibrated by UpdateLocalCoords()
+    const LTAPILocalFrame& getLocalFrame () const { return localFrame; }
+    
+    /// @brief Enables maintaining a spatial grid index of all aircraft
+    /// @details If enabled, UpdateAcList() maintains an LTAPIGridIndex,
+    ///          which answers nearest-N and radius queries, see getGrid().
+    /// @param bEnable Enable or disable; enabling fills the index from the current aircraft
+    /// @param cellDeg [°] cell size, choose roughly the radius of your typical queries
+    void EnableGrid (bool bEnable = true, double cellDeg = 0.5);
+    /// Is the spatial grid index maintained?
+    bool isGridEnabled () const { return bGrid; }
+    /// Spatial grid index of all aircraft, empty unless enabled via EnableGrid()
+    const LTAPIGridIndex& getGrid () const { return grid; }
+    
+    /// @brief Enables hashed indexes by call sign, registration, and flight number
+    /// @details If enabled, UpdateAcList() maintains the indexes used by
+    ///          findByCallSign(), findByRegistration(), and findByFlightNumber().
+    ///          Only aircraft whose texts changed during the expensive fetch are re-indexed.
+    /// @param bEnable Enable or disable; enabling indexes the current aircraft
+    void EnableTextIndex (bool bEnable = true);
+    /// Are the text indexes maintained?
+    bool isTextIndexEnabled () const { return bool(pTextIdx); }
+    /// @brief Finds an aircraft by exact call sign like "DLH56C"
+    /// @details Texts need not be unique. If several aircraft match,
+    ///          the one with the lowest key is returned, see findAllByCallSign().
+    /// @return Aircraft found, empty if none found or text indexes not enabled
+    SPtrLTAPIAircraft findByCallSign (const std::string& callSign) const;
+    /// @brief Finds an aircraft by exact registration like "D-AISD"
+    /// @details If several aircraft match, the one with the lowest key is returned.
+    /// @return Aircraft found, empty if none found or text indexes not enabled
+    SPtrLTAPIAircraft findByRegistration (const std::string& registration) const;
+    /// @brief Finds an aircraft by exact flight number like "LH1113"
+    /// @details If several aircraft match, the one with the lowest key is returned.
+    /// @return Aircraft found, empty if none found or text indexes not enabled
+    SPtrLTAPIAircraft findByFlightNumber (const std::string& flightNumber) const;
+    /// @brief Finds all aircraft with the exact call sign
+    /// @param[out] outAc Cleared, then receives all aircraft found, sorted by key
+    /// @return Number of aircraft found, `0` also if text indexes not enabled
+    size_t findAllByCallSign (const std::string& callSign, VecLTAPIAircraft& outAc) const;
+    /// Finds all aircraft with the exact registration, see findAllByCallSign()
+    size_t findAllByRegistration (const std::string& registration, VecLTAPIAircraft& outAc) const;
+    /// Finds all aircraft with the exact flight number, see findAllByCallSign()
+    size_t findAllByFlightNumber (const std::string& flightNumber, VecLTAPIAircraft& outAc) const;
+    
+    /// @brief Enables publishing of immutable snapshots for other threads
+    /// @details If enabled, each UpdateAcList() call ends with copying all aircraft
+    ///          data, sorted by key, into a snapshot and publishing it (RCU-style).
+    ///          Readers on any thread acquire it via getSnapshot(). Buffers of
+    ///          snapshots no longer held by readers are reused.
+    /// @note    This is a lock-based RCU, not a lock-free one: Publishing and acquiring
+    ///          use `std::atomic_exchange`/`std::atomic_load` on the `std::shared_ptr`,
+    ///          which standard libraries implement with a pool of spin locks.
+    ///          Readers and the flight loop contend only for copying one smart pointer,
+    ///          never while the fleet is copied. (Deprecated in C++20 in favour of
+    ///          `std::atomic<std::shared_ptr>`, which LTAPI can't use as a C++17 library.)
+    /// @param bEnable Enable or disable; disabling releases the current snapshot
+    void EnableSnapshots (bool bEnable = true);
+    /// Are snapshots being published?
+    bool areSnapshotsEnabled () const { return bSnapshots; }
+    /// @brief Returns the latest published snapshot, can be called from any thread
+    /// @return Latest snapshot, empty pointer if none published yet
+    SPtrLTAPISnapshot getSnapshot () const { return std::atomic_load(&spSnapshot); }
+    
+    /// @brief Enables reporting of added, updated, and removed aircraft per UpdateAcList() call
+    /// @details Each aircraft is reported at most once per call. An aircraft counts
+    ///          as updated if any of its numeric or textual data received changed.
+    ///          Retrieve the events via getEvents() or have them passed to callbacks
+    ///          registered via RegisterEventCB().
+    /// @param bEnable Enable or disable; disabling also clears the last events
+    void EnableEvents (bool bEnable = true);
+    /// Are events being reported?
+    bool areEventsEnabled () const { return bEvents; }
+    /// Events of the last UpdateAcList() call, empty if not enabled
+    const VecLTAPIAcEvent& getEvents () const { return vEvents; }
+    /// @brief Registers a callback called at the end of UpdateAcList() if there were events
+    /// @details Enables events if not yet enabled.
+    ///          Registering the same callback/refcon pair again has no effect.
+    /// @param pfCB Callback function
+    /// @param refcon Reference value passed to the callback
+    void RegisterEventCB (fAcEventCB* pfCB, void* refcon = nullptr);
+    /// Unregisters a callback/refcon pair registered via RegisterEventCB()
+    void UnregisterEventCB (fAcEventCB* pfCB, void* refcon = nullptr);
+    
+    /// @brief Starts recording all raw bulk data received from LiveTraffic into a capture file
+    /// @details Each UpdateAcList() call writes one cycle record with the number of aircraft,
+    ///          followed by one record per received bulk of `LTAPIBulkData` or
+    ///          `LTAPIBulkInfoTexts`, each with the negotiated struct size
+    ///          and a timestamp. Replay with StartReplay().
+    /// @param path Path of capture file, will be overwritten
+    /// @return Could the file be created?
+    bool StartRecording (const std::string& path);
+    /// Stops recording and closes the capture file
+    void StopRecording ();
+    /// Currently recording?
+    bool isRecording () const { return fCapture != nullptr; }
+    
+    /// @brief Replays a capture file instead of fetching data from LiveTraffic
+    /// @details The file is memory-mapped and its data is processed in place by
+    ///          the same code path that handles live data, without copying.
+    ///          Each UpdateAcList() call replays one recorded cycle.
+    ///          The expensive fetch is replayed exactly when it was recorded.
+    ///          Once the end is reached, no aircraft are reported any longer.
+    /// @param path Path of capture file written by StartRecording()
+    /// @return Could the file be mapped, and was it recorded with the same structure sizes?
+    bool StartReplay (const std::string& path);
+    /// Stops replaying, returns to live data
+    void StopReplay ();
+    /// Currently replaying?
+    bool isReplaying () const { return bool(pReplay); }
+    /// Has replay reached the end of the capture file?
+    bool isReplayAtEnd () const;
+    /// Restarts replay from the beginning of the capture file
+    void RewindReplay ();
+    
+    /// @brief Enables fetching numeric data by distance-based level-of-detail tiers
+    /// @details Based on `dist_nm` of the last fetch, aircraft are grouped into tiers.
+    ///          Each tier's numeric data is fetched only every `intvl`-th call,
+    ///          staggered by offset so that the load spreads over calls.
+    ///          Aircraft beyond the farthest tier are fetched with the full fetch
+    ///          every `fullIntvl`-th call only, which is also when removed aircraft are detected.
+    ///          Changes to LiveTraffic's list of aircraft, detected by a changed number
+    ///          of aircraft or by aircraft found at different offsets, trigger a full fetch, too.
+    ///          Aircraft not fetched keep their previous numeric values, which
+    ///          LTAPIAircraft::isUpdated() tells (also if texts were fetched in that call).
+    ///          The multiplayer slot table and the camera aircraft are only rebuilt
+    ///          by full fetches, too: In between, an aircraft that left its slot
+    ///          or the camera view keeps being returned by getAcByMultIdx() and
+    ///          getAcInCameraView() until the next full fetch, unless a fetched aircraft takes its place.
+    ///          Not applied while a time budget is set or while recording or replaying.
+    /// @param bEnable Enable or disable
+    /// @param tiers Tiers to use, defaults to 25 nm every call, 75 nm every 2nd, 150 nm every 4th call
+    /// @param fullIntvl Fetch all aircraft every `fullIntvl`-th call
+    void EnableLOD (bool bEnable = true,
+                    const std::vector<LODTier>& tiers = std::vector<LODTier>(),
+                    unsigned fullIntvl = 8);
+    /// Is level-of-detail fetching enabled?
+    bool isLODEnabled () const { return bLOD; }
+    
+    /// @brief Has the last UpdateAcList() call completed a sweep over all aircraft?
+    /// @details Always `true` unless `usUpdateBudget` is set.
+    ///          (Level-of-detail calls between full fetches count as complete, see EnableLOD().)
+    ///          If `false` then the next call resumes where this one stopped.
+    bool isSweepComplete () const { return sweepAc == 0 && !bSweepExpsv; }
+    
 protected:
+    /// @brief Fetches all data from LiveTraffic and updates `mapAcNum` (and `mapAc` if `bMapStr`)
+    /// @tparam ContT Container receiving removed aircraft, ListLTAPIAircraft or VecLTAPIAircraft
+    template <class ContT>
+    void DoUpdateAcList (ContT* pRemovedAc);
+    
     /// @brief fetch bulk data and create/update aircraft objects
     /// @param numAc Total number of aircraft to fetch
     /// @param DR The dataRef to use for fetching the actual data from LT
     /// @param[out] outSizeLT Returns LT's structure size
     /// @param vBulk Reference to allocated memory for data transfer
+    /// @param[in,out] ioAc Offset to start fetching at; returns the offset
+    ///                to resume at, or `0` if all aircraft have been fetched
+    /// @param tDeadline Stop after the bulk, during which this point in time has been passed
+    /// @param pRanges (Optional) Fetch only these ranges of offsets instead of all
+    ///                aircraft from `ioAc` on, ignoring `tDeadline`; not used when replaying.
+    ///                If the numeric fetch finds aircraft at different offsets than last time,
+    ///                it continues as a full fetch of the offsets not yet fetched.
     /// @tparam T is the structure to fill, either LTAPIAircraft::LTAPIBulkData or LTAPIAircraft::LTAPIBulkInfoTexts
     /// @return Have aircraft objects been created?
     template <class T>
     bool DoBulkFetch (int numAc, LTDataRef& DR, int& outSizeLT,
-                      std::unique_ptr<T[]> &vBulk);
+                      std::unique_ptr<T[]> &vBulk, int& ioAc,
+                      std::chrono::time_point<std::chrono::steady_clock> tDeadline,
+                      const VecAcRange* pRanges = nullptr);
+    
+    /// @brief Determines the sorted, non-overlapping ranges of offsets for the sliced expensive fetch of this call into `vExpsvRanges`
+    /// @param numAc Total number of aircraft
+    /// @param bSlice Add the next round-robin slice? (Otherwise only offsets of new aircraft)
+    void PlanExpsvSlice (int numAc, bool bSlice);
+    
+    /// @brief Determines the ranges of offsets due in this level-of-detail call into `vLODRanges`
+    /// @param numAc Total number of aircraft
+    void PlanLODRanges (int numAc);
+    
+    /// Finalizes the current call's statistics
+    void StatsFinishCall (std::chrono::steady_clock::time_point tStart);
+    
+    /// Creates a new aircraft object via the creation callback
+    SPtrLTAPIAircraft CreateAc ();
+    
+    /// Returns the smart pointer to an aircraft in `mapAcNum`
+    SPtrLTAPIAircraft getSPtr (const LTAPIAircraft* pAc) const;
+    /// Finds all aircraft with the exact text in one field of the text indexes, see findAllByCallSign()
+    size_t FindAllByText (int field, const std::string& s, VecLTAPIAircraft& outAc) const;
+    
+    /// Removes an aircraft's row from `cols`
+    void ColRemove (LTAPIAircraft* pAc);
+    
+    /// Copies all aircraft data into a snapshot and publishes it
+    void PublishSnapshot ();
+    
+    /// Adds an event for the aircraft unless it has already been reported during this call
+    void AddEvent (LTAPIAircraft* pAc, LTAPIAcEvent::EventTy ev);
+    /// Calls the registered event callbacks if there were events
+    void NotifyEvents ();
+    
+    /// Writes one record to the capture file
+    void WriteCaptureRec (uint32_t type, int sizeLT, int offset,
+                          const void* pData, int numBytes);
     
     /// @brief shared DataRef event notification
     static void CameraSharedDataCB (LTAPIConnect* me);